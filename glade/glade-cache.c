@@ -0,0 +1,699 @@
+/* -*- Mode: C; c-basic-offset: 4 -*-
+ * libglade - a library for building interfaces from XML files at runtime
+ * Copyright (C) 1998-2002  James Henstridge <james@daa.com.au>
+ *
+ * glade-cache.c: caches shared between all GladeXML objects.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA  02111-1307, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
+#include <gtk/gtk.h>
+
+#include <glade/glade-xml.h>
+#include <glade/glade-private.h>
+
+/* the pixbuf cache.  Images referenced from interfaces are decoded
+ * once and shared by every widget that uses them, so a toolbar icon
+ * used in many windows only costs a reference the second time.
+ * Entries are keyed by filename and checked against the file's
+ * modification time, and the least recently used ones are dropped
+ * once the decoded pixel data goes over the size limit. */
+
+#define DEFAULT_PIXBUF_CACHE_SIZE (4 * 1024 * 1024)
+
+typedef struct _GladePixbufCacheEntry GladePixbufCacheEntry;
+struct _GladePixbufCacheEntry {
+    gchar *filename;
+    time_t mtime;
+    GdkPixbuf *pixbuf;
+    gsize size;
+    GList *link;  /* this entry's node in pixbuf_lru */
+};
+
+static GStaticMutex pixbuf_cache_mutex = G_STATIC_MUTEX_INIT;
+static GHashTable *pixbuf_cache = NULL;
+static GQueue *pixbuf_lru = NULL; /* most recently used at the head */
+static gsize pixbuf_cache_size = 0;
+static gsize pixbuf_cache_max_size = DEFAULT_PIXBUF_CACHE_SIZE;
+static guint pixbuf_cache_hits = 0;
+static guint pixbuf_cache_misses = 0;
+
+/* files being decoded by _glade_pixbuf_cache_prefetch(), and the
+ * condition signalled when one of them is done.  Only used once
+ * threads have been initialised. */
+static GHashTable *pixbuf_pending = NULL;
+static GCond *pixbuf_pending_cond = NULL;
+
+#define PIXBUF_CACHE_LOCK()   g_static_mutex_lock(&pixbuf_cache_mutex)
+#define PIXBUF_CACHE_UNLOCK() g_static_mutex_unlock(&pixbuf_cache_mutex)
+
+static gsize
+pixbuf_data_size(GdkPixbuf *pixbuf)
+{
+    return gdk_pixbuf_get_rowstride(pixbuf) * gdk_pixbuf_get_height(pixbuf);
+}
+
+/* must be called with the lock held */
+static void
+pixbuf_cache_ensure(void)
+{
+    if (!pixbuf_cache) {
+	pixbuf_cache = g_hash_table_new(g_str_hash, g_str_equal);
+	pixbuf_lru = g_queue_new();
+    }
+}
+
+/* must be called with the lock held */
+static void
+pixbuf_cache_remove(GladePixbufCacheEntry *entry)
+{
+    g_hash_table_remove(pixbuf_cache, entry->filename);
+    g_queue_delete_link(pixbuf_lru, entry->link);
+    pixbuf_cache_size -= entry->size;
+
+    g_object_unref(entry->pixbuf);
+    g_free(entry->filename);
+    g_free(entry);
+}
+
+/* must be called with the lock held */
+static void
+pixbuf_cache_trim(gsize max_size)
+{
+    while (pixbuf_cache_size > max_size && pixbuf_lru->tail)
+	pixbuf_cache_remove(pixbuf_lru->tail->data);
+}
+
+/* look up an up to date entry, dropping a stale one.  Must be called
+ * with the lock held. */
+static GladePixbufCacheEntry *
+pixbuf_cache_lookup(const gchar *filename, time_t mtime)
+{
+    GladePixbufCacheEntry *entry;
+
+    entry = g_hash_table_lookup(pixbuf_cache, filename);
+    if (entry && entry->mtime != mtime) {
+	/* the file has changed since */
+	pixbuf_cache_remove(entry);
+	entry = NULL;
+    }
+    return entry;
+}
+
+/* add a freshly decoded pixbuf to the cache and return the pixbuf the
+ * caller should use.  Consumes the reference to @pixbuf.  Must be
+ * called with the lock held. */
+static GdkPixbuf *
+pixbuf_cache_insert(const gchar *filename, time_t mtime, GdkPixbuf *pixbuf)
+{
+    GladePixbufCacheEntry *entry;
+
+    entry = pixbuf_cache_lookup(filename, mtime);
+    if (entry) {
+	/* someone else loaded it in the mean time */
+	g_object_unref(pixbuf);
+	return g_object_ref(entry->pixbuf);
+    }
+    if (pixbuf_data_size(pixbuf) > pixbuf_cache_max_size)
+	return pixbuf;
+
+    entry = g_new(GladePixbufCacheEntry, 1);
+    entry->filename = g_strdup(filename);
+    entry->mtime = mtime;
+    entry->pixbuf = g_object_ref(pixbuf);
+    entry->size = pixbuf_data_size(pixbuf);
+
+    g_queue_push_head(pixbuf_lru, entry);
+    entry->link = pixbuf_lru->head;
+    g_hash_table_insert(pixbuf_cache, entry->filename, entry);
+    pixbuf_cache_size += entry->size;
+
+    pixbuf_cache_trim(pixbuf_cache_max_size);
+    return pixbuf;
+}
+
+static GdkPixbuf *
+pixbuf_cache_load(const gchar *filename, GError **error)
+{
+    GladePixbufCacheEntry *entry;
+    GdkPixbuf *pixbuf;
+    struct stat statbuf;
+
+    /* if we can't stat it, let the loader report the problem */
+    if (g_stat(filename, &statbuf) != 0)
+	return gdk_pixbuf_new_from_file(filename, error);
+
+    PIXBUF_CACHE_LOCK();
+    pixbuf_cache_ensure();
+
+    /* if a prefetch is decoding this file, wait for it rather than
+     * decoding it a second time */
+    while (pixbuf_pending &&
+	   g_hash_table_lookup(pixbuf_pending, filename) != NULL)
+	g_cond_wait(pixbuf_pending_cond,
+		    g_static_mutex_get_mutex(&pixbuf_cache_mutex));
+
+    entry = pixbuf_cache_lookup(filename, statbuf.st_mtime);
+    if (entry) {
+	pixbuf_cache_hits++;
+	g_queue_unlink(pixbuf_lru, entry->link);
+	g_queue_push_head_link(pixbuf_lru, entry->link);
+	pixbuf = g_object_ref(entry->pixbuf);
+	PIXBUF_CACHE_UNLOCK();
+	return pixbuf;
+    }
+    pixbuf_cache_misses++;
+    PIXBUF_CACHE_UNLOCK();
+
+    /* don't hold the lock while decoding */
+    pixbuf = gdk_pixbuf_new_from_file(filename, error);
+    if (!pixbuf)
+	return NULL;
+
+    PIXBUF_CACHE_LOCK();
+    pixbuf = pixbuf_cache_insert(filename, statbuf.st_mtime, pixbuf);
+    PIXBUF_CACHE_UNLOCK();
+
+    return pixbuf;
+}
+
+/* load an image file, sharing the result with earlier loads of the
+ * same unmodified file.  Returns a new reference, or NULL on error.
+ * The pixbuf may be in use elsewhere, so it must not be modified. */
+GdkPixbuf *
+_glade_pixbuf_cache_load(const gchar *filename, GError **error)
+{
+    GdkPixbuf *pixbuf;
+
+    g_return_val_if_fail(filename != NULL, NULL);
+
+    GLADE_TRACE_BEGIN(filename, "image", NULL, NULL);
+    pixbuf = pixbuf_cache_load(filename, error);
+    GLADE_TRACE_END(filename, "image");
+
+    return pixbuf;
+}
+
+/* decode an image file into the cache, unless it is already there
+ * or being decoded.  This is meant to be run from worker threads, so
+ * errors are ignored: the file will be loaded again, and the error
+ * reported, by whoever actually needs it. */
+void
+_glade_pixbuf_cache_prefetch(const gchar *filename)
+{
+    GdkPixbuf *pixbuf;
+    struct stat statbuf;
+
+    g_return_if_fail(g_thread_supported());
+
+    if (g_stat(filename, &statbuf) != 0)
+	return;
+
+    PIXBUF_CACHE_LOCK();
+    pixbuf_cache_ensure();
+    if (!pixbuf_pending) {
+	pixbuf_pending = g_hash_table_new_full(g_str_hash, g_str_equal,
+					       g_free, NULL);
+	pixbuf_pending_cond = g_cond_new();
+    }
+    if (g_hash_table_lookup(pixbuf_pending, filename) != NULL ||
+	pixbuf_cache_lookup(filename, statbuf.st_mtime) != NULL) {
+	PIXBUF_CACHE_UNLOCK();
+	return;
+    }
+    g_hash_table_insert(pixbuf_pending, g_strdup(filename),
+			GINT_TO_POINTER(TRUE));
+    pixbuf_cache_misses++;
+    PIXBUF_CACHE_UNLOCK();
+
+    GLADE_TRACE_BEGIN(filename, "image", "prefetch", "yes");
+    pixbuf = gdk_pixbuf_new_from_file(filename, NULL);
+    GLADE_TRACE_END(filename, "image");
+
+    PIXBUF_CACHE_LOCK();
+    if (pixbuf)
+	g_object_unref(pixbuf_cache_insert(filename, statbuf.st_mtime,
+					   pixbuf));
+    g_hash_table_remove(pixbuf_pending, filename);
+    g_cond_broadcast(pixbuf_pending_cond);
+    PIXBUF_CACHE_UNLOCK();
+}
+
+/**
+ * glade_pixbuf_cache_set_max_size:
+ * @max_size: the maximum number of bytes of pixel data to keep.
+ *
+ * Sets how much decoded image data libglade keeps around for reuse
+ * by later interfaces.  Images that are still in use by widgets are
+ * not freed by dropping them from the cache, so this only limits the
+ * memory held on behalf of interfaces that may be built later.  A
+ * size of 0 disables the cache.  The default is 4 megabytes.
+ */
+void
+glade_pixbuf_cache_set_max_size(gsize max_size)
+{
+    PIXBUF_CACHE_LOCK();
+    pixbuf_cache_max_size = max_size;
+    if (pixbuf_cache)
+	pixbuf_cache_trim(max_size);
+    PIXBUF_CACHE_UNLOCK();
+}
+
+/**
+ * glade_pixbuf_cache_get_max_size:
+ *
+ * Returns: the size limit set with glade_pixbuf_cache_set_max_size().
+ */
+gsize
+glade_pixbuf_cache_get_max_size(void)
+{
+    return pixbuf_cache_max_size;
+}
+
+/**
+ * glade_pixbuf_cache_get_stats:
+ * @hits: return location for the number of loads served from the
+ * cache, or %NULL.
+ * @misses: return location for the number of loads that had to
+ * decode the file, or %NULL.
+ * @size: return location for the number of bytes of pixel data
+ * currently cached, or %NULL.
+ *
+ * Reports how well the pixbuf cache is doing.
+ */
+void
+glade_pixbuf_cache_get_stats(guint *hits, guint *misses, gsize *size)
+{
+    PIXBUF_CACHE_LOCK();
+    if (hits)
+	*hits = pixbuf_cache_hits;
+    if (misses)
+	*misses = pixbuf_cache_misses;
+    if (size)
+	*size = pixbuf_cache_size;
+    PIXBUF_CACHE_UNLOCK();
+}
+
+/**
+ * glade_pixbuf_cache_clear:
+ *
+ * Drops all images from the pixbuf cache and resets its counters.
+ */
+void
+glade_pixbuf_cache_clear(void)
+{
+    PIXBUF_CACHE_LOCK();
+    if (pixbuf_cache)
+	pixbuf_cache_trim(0);
+    pixbuf_cache_hits = 0;
+    pixbuf_cache_misses = 0;
+    PIXBUF_CACHE_UNLOCK();
+}
+
+/* resolved symbols.  Signal autoconnection and custom widgets look
+ * functions up by name in the application.  The same names come up
+ * every time a dialog is built, so the results are kept, including
+ * the names that couldn't be found. */
+
+G_LOCK_DEFINE_STATIC(symbol_cache_lock);
+static GModule *symbol_module = NULL;
+static GHashTable *symbol_cache = NULL;
+static guint symbol_cache_hits = 0;
+static guint symbol_cache_misses = 0;
+
+/**
+ * glade_symbol_cache_lookup:
+ * @name: the name of a function.
+ *
+ * Looks up a function in the application's symbol table, the way
+ * glade_xml_signal_autoconnect() does.  The result is cached, so
+ * resolving the same name again is only a hash table lookup.  Names
+ * that can't be resolved are cached as well.
+ *
+ * Returns: the function, or %NULL if it could not be found or gmodule
+ * is not supported on this platform.
+ */
+GCallback
+glade_symbol_cache_lookup(const gchar *name)
+{
+    gpointer orig_key, value;
+    GCallback func = NULL;
+
+    g_return_val_if_fail(name != NULL, NULL);
+
+    if (!g_module_supported())
+	return NULL;
+
+    G_LOCK(symbol_cache_lock);
+    if (!symbol_module) {
+	/* a handle on the main executable, which is never closed */
+	symbol_module = g_module_open(NULL, 0);
+	symbol_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free, NULL);
+    }
+
+    if (g_hash_table_lookup_extended(symbol_cache, name, &orig_key, &value)) {
+	symbol_cache_hits++;
+	func = (GCallback)value;
+    } else {
+	symbol_cache_misses++;
+	if (!g_module_symbol(symbol_module, name, (gpointer)&func))
+	    func = NULL;
+	g_hash_table_insert(symbol_cache, g_strdup(name), (gpointer)func);
+    }
+    G_UNLOCK(symbol_cache_lock);
+
+    return func;
+}
+
+/**
+ * glade_symbol_cache_get_stats:
+ * @hits: return location for the number of lookups answered from the
+ * cache, or %NULL.
+ * @misses: return location for the number of lookups that had to
+ * search the symbol table, or %NULL.
+ *
+ * Reports how well the symbol cache is doing.
+ */
+void
+glade_symbol_cache_get_stats(guint *hits, guint *misses)
+{
+    G_LOCK(symbol_cache_lock);
+    if (hits)
+	*hits = symbol_cache_hits;
+    if (misses)
+	*misses = symbol_cache_misses;
+    G_UNLOCK(symbol_cache_lock);
+}
+
+/**
+ * glade_symbol_cache_clear:
+ *
+ * Forgets all resolved symbols and resets the counters.  This should
+ * be called if a module that provides signal handlers is loaded after
+ * a lookup has failed, so that the failure is not remembered.
+ */
+void
+glade_symbol_cache_clear(void)
+{
+    G_LOCK(symbol_cache_lock);
+    if (symbol_cache) {
+	g_hash_table_destroy(symbol_cache);
+	symbol_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free, NULL);
+    }
+    symbol_cache_hits = 0;
+    symbol_cache_misses = 0;
+    G_UNLOCK(symbol_cache_lock);
+}
+
+/* allocated colours.  Parsing a colour is cheap, but allocating it
+ * in a colormap can mean a round trip to the X server.  Interfaces
+ * tend to use the same few colours over and over, so each colormap
+ * gets a table of the colours allocated in it, keyed by the string
+ * they were parsed from.  The colours are freed again when the
+ * colormap goes away. */
+
+static GQuark glade_colour_cache_id = 0;
+
+static void
+free_colour(gpointer key, gpointer value, gpointer user_data)
+{
+    gdk_colormap_free_colors(GDK_COLORMAP(user_data), value, 1);
+}
+
+/* this is a weak ref, so the colormap is still usable */
+static void
+colour_cache_free(gpointer data, GObject *where_the_colormap_was)
+{
+    GHashTable *colours = data;
+
+    g_hash_table_foreach(colours, free_colour, where_the_colormap_was);
+    g_hash_table_destroy(colours);
+}
+
+/* parse @spec and allocate the colour in @colormap, reusing an
+ * earlier allocation of the same colour.  Returns FALSE if the colour
+ * couldn't be parsed or allocated. */
+gboolean
+_glade_colormap_get_color(GdkColormap *colormap, const gchar *spec,
+			  GdkColor *colour)
+{
+    GHashTable *colours;
+    GdkColor *cached;
+
+    if (!glade_colour_cache_id)
+	glade_colour_cache_id =
+	    g_quark_from_static_string("libglade::colour-cache");
+
+    colours = g_object_get_qdata(G_OBJECT(colormap), glade_colour_cache_id);
+    if (!colours) {
+	colours = g_hash_table_new_full(g_str_hash, g_str_equal,
+					g_free, g_free);
+	g_object_set_qdata(G_OBJECT(colormap), glade_colour_cache_id,
+			   colours);
+	g_object_weak_ref(G_OBJECT(colormap), colour_cache_free, colours);
+    }
+
+    cached = g_hash_table_lookup(colours, spec);
+    if (!cached) {
+	GdkColor parsed = { 0, };
+
+	if (!gdk_color_parse(spec, &parsed) ||
+	    !gdk_colormap_alloc_color(colormap, &parsed, FALSE, TRUE))
+	    return FALSE;
+	cached = g_new(GdkColor, 1);
+	*cached = parsed;
+	g_hash_table_insert(colours, g_strdup(spec), cached);
+    }
+    *colour = *cached;
+    return TRUE;
+}
+
+/* lazily loaded images (GLADE_BUILD_LAZY_IMAGES).  While building,
+ * an image gets a transparent placeholder of the right size, which
+ * keeps the layout the same.  The file is decoded when the widget
+ * using it is first mapped.  With threads, this happens on a worker
+ * thread, and the result is handed back to the main loop. */
+
+#define LAZY_IMAGE_THREADS 2
+
+typedef struct _GladeLazyImage GladeLazyImage;
+struct _GladeLazyImage {
+    GtkWidget *widget;
+    gchar *filename;
+    GladeLazyImageFunc func;
+    gpointer data;
+    GdkPixbuf *pixbuf;
+    GError *error;
+};
+
+static GThreadPool *lazy_image_pool = NULL;
+
+/* placeholders are only made while building, in the main thread.
+ * There is one for each size, shared by the images of that size, so
+ * they must never be modified.  The size of each file is kept, checked
+ * against its modification time like the pixbuf cache, so its header
+ * is only read once.  Both tables are emptied when they get too big;
+ * the placeholders handed out stay valid, as each image holds a
+ * reference to its own. */
+
+#define MAX_PLACEHOLDER_FILES 256
+
+typedef struct _GladePlaceholderFile GladePlaceholderFile;
+struct _GladePlaceholderFile {
+    time_t mtime;
+    GdkPixbuf *pixbuf; /* owned by placeholder_sizes */
+};
+
+static GQuark glade_placeholder_id = 0;
+static GHashTable *placeholder_sizes = NULL;
+static GHashTable *placeholder_files = NULL;
+
+/* return a placeholder for an image file, or NULL if the file can't
+ * be recognised.  The caller owns a reference to it. */
+GdkPixbuf *
+_glade_pixbuf_placeholder_new(const gchar *filename)
+{
+    GladePlaceholderFile *file;
+    GdkPixbuf *pixbuf;
+    struct stat statbuf;
+    gint width, height;
+    gchar size[32];
+
+    if (placeholder_files &&
+	g_hash_table_size(placeholder_files) >= MAX_PLACEHOLDER_FILES) {
+	g_hash_table_destroy(placeholder_files);
+	g_hash_table_destroy(placeholder_sizes);
+	placeholder_files = NULL;
+    }
+    if (!placeholder_files) {
+	placeholder_sizes = g_hash_table_new_full(g_str_hash, g_str_equal,
+						  g_free, g_object_unref);
+	placeholder_files = g_hash_table_new_full(g_str_hash, g_str_equal,
+						  g_free, g_free);
+	glade_placeholder_id =
+	    g_quark_from_static_string("libglade::placeholder");
+    }
+
+    if (g_stat(filename, &statbuf) != 0)
+	return NULL;
+    file = g_hash_table_lookup(placeholder_files, filename);
+    if (file && file->mtime == statbuf.st_mtime)
+	return g_object_ref(file->pixbuf);
+
+    if (!gdk_pixbuf_get_file_info(filename, &width, &height))
+	return NULL;
+
+    g_snprintf(size, sizeof(size), "%dx%d", width, height);
+    pixbuf = g_hash_table_lookup(placeholder_sizes, size);
+    if (!pixbuf) {
+	pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+	if (!pixbuf)
+	    return NULL;
+	gdk_pixbuf_fill(pixbuf, 0);
+	g_object_set_qdata(G_OBJECT(pixbuf), glade_placeholder_id,
+			   GINT_TO_POINTER(TRUE));
+	g_hash_table_insert(placeholder_sizes, g_strdup(size), pixbuf);
+    }
+    file = g_new(GladePlaceholderFile, 1);
+    file->mtime = statbuf.st_mtime;
+    file->pixbuf = pixbuf;
+    g_hash_table_replace(placeholder_files, g_strdup(filename), file);
+    return g_object_ref(pixbuf);
+}
+
+/* whether @pixbuf is a placeholder */
+gboolean
+_glade_pixbuf_is_placeholder(GdkPixbuf *pixbuf)
+{
+    return glade_placeholder_id != 0 &&
+	g_object_get_qdata(G_OBJECT(pixbuf), glade_placeholder_id) != NULL;
+}
+
+/* a GladeLazyImageFunc that sets the property named by @data, unless
+ * something else has replaced the placeholder since */
+void
+_glade_lazy_image_set_property(GtkWidget *widget, GdkPixbuf *pixbuf,
+			       gpointer data)
+{
+    GdkPixbuf *current = NULL;
+    gboolean placeholder;
+
+    g_object_get(G_OBJECT(widget), (const gchar *)data, &current, NULL);
+    if (!current)
+	return;
+    placeholder = _glade_pixbuf_is_placeholder(current);
+    g_object_unref(current);
+
+    if (placeholder)
+	g_object_set(G_OBJECT(widget), (const gchar *)data, pixbuf, NULL);
+}
+
+static void
+lazy_image_finish(GladeLazyImage *image)
+{
+    if (image->pixbuf) {
+	image->func(image->widget, image->pixbuf, image->data);
+	g_object_unref(image->pixbuf);
+    } else {
+	g_warning("Error loading image: %s", image->error->message);
+	g_error_free(image->error);
+    }
+    g_object_unref(image->widget);
+    g_free(image->filename);
+    g_free(image);
+}
+
+static gboolean
+lazy_image_idle(gpointer data)
+{
+    GDK_THREADS_ENTER();
+    lazy_image_finish(data);
+    GDK_THREADS_LEAVE();
+    return FALSE;
+}
+
+static void
+lazy_image_decode(gpointer data, gpointer user_data)
+{
+    GladeLazyImage *image = data;
+
+    image->pixbuf = _glade_pixbuf_cache_load(image->filename, &image->error);
+    g_idle_add(lazy_image_idle, image);
+}
+
+static void
+lazy_image_map(GtkWidget *widget, GladeLazyImage *pending)
+{
+    GladeLazyImage *image;
+
+    /* the handler's data gets freed when it is disconnected */
+    image = g_new0(GladeLazyImage, 1);
+    image->widget = g_object_ref(widget);
+    image->filename = g_strdup(pending->filename);
+    image->func = pending->func;
+    image->data = pending->data;
+    g_signal_handlers_disconnect_by_func(widget, lazy_image_map, pending);
+
+    if (g_thread_supported()) {
+	if (!lazy_image_pool)
+	    lazy_image_pool = g_thread_pool_new(lazy_image_decode, NULL,
+						LAZY_IMAGE_THREADS,
+						FALSE, NULL);
+	g_thread_pool_push(lazy_image_pool, image, NULL);
+    } else {
+	image->pixbuf = _glade_pixbuf_cache_load(image->filename,
+						 &image->error);
+	lazy_image_finish(image);
+    }
+}
+
+static void
+lazy_image_free(gpointer data, GClosure *closure)
+{
+    GladeLazyImage *pending = data;
+
+    g_free(pending->filename);
+    g_free(pending);
+}
+
+/* arrange for @filename to be loaded when @widget is first mapped,
+ * and for @func to be called with the result. */
+void
+_glade_lazy_image_add(GtkWidget *widget, const gchar *filename,
+		      GladeLazyImageFunc func, gpointer data)
+{
+    GladeLazyImage *pending;
+
+    pending = g_new0(GladeLazyImage, 1);
+    pending->filename = g_strdup(filename);
+    pending->func = func;
+    pending->data = data;
+    g_signal_connect_data(widget, "map", G_CALLBACK(lazy_image_map),
+			  pending, lazy_image_free, 0);
+
+    if (GTK_WIDGET_MAPPED(widget))
+	lazy_image_map(widget, pending);
+}
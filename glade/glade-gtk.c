@@ -100,21 +100,11 @@ pixmap_set_build_insensitive (GladeXML *xml, GtkWidget *w,
 }
 
 static void
-pixmap_set_filename (GladeXML *xml, GtkWidget *w,
-		     const char *name, const char *value)
+pixmap_set_pixbuf (GtkWidget *w, GdkPixbuf *pb, gpointer data)
 {
-    GdkPixbuf *pb;
-    char *file;
     GdkPixmap *pixmap = NULL;
     GdkBitmap *bitmap = NULL;
     GdkColormap *cmap;
-    
-    file = glade_xml_relative_file (xml, value);
-    pb = gdk_pixbuf_new_from_file (file, NULL);
-    g_free (file);
-
-    if (!pb)
-	return;
 
     cmap = gtk_widget_get_colormap (w);
     gdk_pixbuf_render_pixmap_and_mask_for_colormap (pb, cmap, &pixmap, &bitmap, 127);
@@ -122,7 +112,29 @@ pixmap_set_filename (GladeXML *xml, GtkWidget *w,
 
     if (pixmap) g_object_unref (pixmap);
     if (bitmap) g_object_unref (bitmap);
+}
 
+static void
+pixmap_set_filename (GladeXML *xml, GtkWidget *w,
+		     const char *name, const char *value)
+{
+    GdkPixbuf *pb = NULL;
+    char *file;
+    
+    file = glade_xml_relative_file (xml, value);
+    if (glade_xml_get_build_flags (xml) & GLADE_BUILD_LAZY_IMAGES) {
+	pb = _glade_pixbuf_placeholder_new (file);
+	if (pb)
+	    _glade_lazy_image_add (w, file, pixmap_set_pixbuf, NULL);
+    }
+    if (!pb)
+	pb = _glade_pixbuf_cache_load (file, NULL);
+    g_free (file);
+
+    if (!pb)
+	return;
+
+    pixmap_set_pixbuf (w, pb, NULL);
     g_object_unref (pb);
 }
 
@@ -444,26 +456,48 @@ toggle_tool_button_set_active (GladeXML *xml, GtkWidget *w,
 				       BOOL (value));
 }
 
+/* create a GtkImage for an icon file, or return NULL if it can't be
+ * loaded.  With GLADE_BUILD_LAZY_IMAGES, the image only gets loaded
+ * when the GtkImage is first mapped. */
+static GtkWidget *
+icon_image_new (GladeXML *xml, const char *file)
+{
+    GdkPixbuf *pb = NULL;
+    GtkWidget *image;
+
+    if (glade_xml_get_build_flags (xml) & GLADE_BUILD_LAZY_IMAGES)
+	pb = _glade_pixbuf_placeholder_new (file);
+    if (pb) {
+	image = gtk_image_new_from_pixbuf (pb);
+	_glade_lazy_image_add (image, file, _glade_lazy_image_set_property,
+			       "pixbuf");
+    } else {
+	pb = _glade_pixbuf_cache_load (file, NULL);
+	if (!pb)
+	    return NULL;
+	image = gtk_image_new_from_pixbuf (pb);
+    }
+    g_object_unref (pb);
+
+    return image;
+}
+
 static void
 tool_button_set_icon (GladeXML *xml, GtkWidget *w,
 		      const char *name, const char *value)
 {
-    GdkPixbuf *pb;
     GtkWidget *image;
     char *file;
 
     file = glade_xml_relative_file (xml, value);
-    pb = gdk_pixbuf_new_from_file (file, NULL);
+    image = icon_image_new (xml, file);
     g_free (file);
 
-    if (!pb) {
+    if (!image) {
 	g_warning ("Couldn't find image file: %s", value);
 	return;
     }
 
-    image = gtk_image_new_from_pixbuf (pb);
-    g_object_unref (pb);
-
     gtk_widget_show (image);
     gtk_tool_button_set_icon_widget (GTK_TOOL_BUTTON (w), image);
 }
@@ -865,7 +899,11 @@ toolbar_build_children (GladeXML *xml, GtkWidget *parent,
 		if (!iconw)
 		    g_warning ("Could not create stock item: %s", stock);
 	    } else if (icon) {
-		iconw = gtk_image_new_from_file (icon);
+		iconw = icon_image_new (xml, icon);
+		/* let GtkImage show its broken image icon for files
+		 * that can't be loaded */
+		if (!iconw)
+		    iconw = gtk_image_new_from_file (icon);
 		g_free (icon);
 	    }
 
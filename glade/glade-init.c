@@ -33,9 +33,7 @@
 #include "glade-build.h"
 #include "glade-private.h"
 
-#ifdef DEBUG
 guint _glade_debug_flags = 0;
-#endif
 
 #ifdef G_OS_WIN32
 
@@ -125,20 +123,21 @@ void
 glade_init(void)
 {
     static gboolean initialised = FALSE;
-#ifdef DEBUG
     const gchar *env_string;
-#endif
 
     if (initialised) return;
     initialised = TRUE;
     _glade_init_gtk_widgets();
 
-#ifdef DEBUG
+    /* "parser" and "build" only have an effect if libglade was built
+     * with debugging enabled */
     env_string = g_getenv("LIBGLADE_DEBUG");
     if (env_string != NULL) {
 	const GDebugKey libglade_debug_keys[] = {
-		{ "parser", GLADE_DEBUG_PARSER },
-		{ "build",  GLADE_DEBUG_BUILD },
+		{ "parser",   GLADE_DEBUG_PARSER },
+		{ "build",    GLADE_DEBUG_BUILD },
+		{ "handlers", GLADE_DEBUG_HANDLERS },
+		{ "profile",  GLADE_DEBUG_PROFILE },
 	};
 
 	_glade_debug_flags = g_parse_debug_string (env_string,
@@ -146,7 +145,14 @@ glade_init(void)
 						   G_N_ELEMENTS (libglade_debug_keys));
 	env_string = NULL;
     }
-#endif
+    if (_glade_debug_flags & GLADE_DEBUG_PROFILE) {
+	_glade_profile_enabled = TRUE;
+	g_atexit(glade_print_profile_stats);
+    }
+
+    env_string = g_getenv("LIBGLADE_TRACE");
+    if (env_string != NULL && glade_trace_start(env_string))
+	g_atexit(glade_trace_stop);
 
 }
 
@@ -220,26 +226,14 @@ find_module (gchar      **module_path,
     return module;
 }
 
-/**
- * glade_require:
- * @library: the required library
- *
- * Ensure that a required library is available.  If it is not already
- * available, libglade will attempt to dynamically load a module that
- * contains the handlers for that library.
- */
-
-void
-glade_require(const gchar *library)
+static void
+glade_require_real(const gchar *library)
 {
     gboolean already_loaded = FALSE;
     GModule *module;
     void (* init_func)(void);
     static char **module_path = NULL;
 
-    /* a call to glade_init here to make sure libglade is initialised */
-    glade_init();
-
     if (loaded_packages) {
 	gint i;
 
@@ -276,6 +270,26 @@ glade_require(const gchar *library)
     g_module_make_resident(module);
 }
 
+/**
+ * glade_require:
+ * @library: the required library
+ *
+ * Ensure that a required library is available.  If it is not already
+ * available, libglade will attempt to dynamically load a module that
+ * contains the handlers for that library.
+ */
+
+void
+glade_require(const gchar *library)
+{
+    /* a call to glade_init here to make sure libglade is initialised */
+    glade_init();
+
+    GLADE_TRACE_BEGIN(library, "require", NULL, NULL);
+    glade_require_real(library);
+    GLADE_TRACE_END(library, "require");
+}
+
 /**
  * glade_provide:
  * @library: the provided library
@@ -172,6 +172,23 @@ create_widget_info(GladeInterface *interface, const xmlChar **attrs)
     return info;
 }
 
+/* append the properties in @array to the @n_props ones at @props, which
+ * may be NULL, and free @array.  A widget's properties can come in more
+ * than one group, for instance when a <signal> comes between them. */
+static GladeProperty *
+merge_properties(GladeProperty *props, guint *n_props, GArray *array)
+{
+    if (props == NULL) {
+	*n_props = array->len;
+	return (GladeProperty *)g_array_free(array, FALSE);
+    }
+    props = g_renew(GladeProperty, props, *n_props + array->len);
+    memcpy(props + *n_props, array->data, array->len * sizeof(GladeProperty));
+    *n_props += array->len;
+    g_array_free(array, TRUE);
+    return props;
+}
+
 static inline void
 flush_properties(GladeParseState *state)
 {
@@ -179,20 +196,17 @@ flush_properties(GladeParseState *state)
 	return;
     switch (state->prop_type) {
     case PROP_NONE:
+	g_array_free(state->props, TRUE);
 	break;
     case PROP_WIDGET:
-	if (state->widget->properties)
-	    g_warning("we already read all the props for this key.  Leaking");
-	state->widget->properties = (GladeProperty *)state->props->data;
-	state->widget->n_properties = state->props->len;
-	g_array_free(state->props, FALSE);
+	state->widget->properties =
+	    merge_properties(state->widget->properties,
+			     &state->widget->n_properties, state->props);
 	break;
     case PROP_ATK:
-	if (state->widget->atk_props)
-	    g_warning("we already read all the ATK props for this key.  Leaking");
-	state->widget->atk_props = (GladeProperty *)state->props->data;
-	state->widget->n_atk_props = state->props->len;
-	g_array_free(state->props, FALSE);
+	state->widget->atk_props =
+	    merge_properties(state->widget->atk_props,
+			     &state->widget->n_atk_props, state->props);
 	break;
     case PROP_CHILD:
 	if (state->widget->n_children == 0) {
@@ -201,11 +215,9 @@ flush_properties(GladeParseState *state)
 	} else {
 	    GladeChildInfo *info = &state->widget->children[
 						state->widget->n_children-1];
-	    if (info->properties)
-		g_warning("we already read all the child props for this key.  Leaking");
-	    info->properties = (GladeProperty *)state->props->data;
-	    info->n_properties = state->props->len;
-	    g_array_free(state->props, FALSE);
+	    info->properties = merge_properties(info->properties,
+						&info->n_properties,
+						state->props);
 	}
 	break;
     }
@@ -456,6 +468,38 @@ handle_child(GladeParseState *state, const xmlChar **attrs)
     }
 }
 
+/* the private data of the interfaces made by the parser.  An
+ * interface allocated elsewhere has none, and is freed the way
+ * glade_interface_destroy() always has. */
+G_LOCK_DEFINE_STATIC(interfaces_lock);
+static GHashTable *interfaces = NULL;
+
+static void
+glade_interface_register(GladeInterface *interface)
+{
+    GladeInterfacePrivate *ipriv = g_new0(GladeInterfacePrivate, 1);
+
+    ipriv->ref_count = 1;
+    G_LOCK(interfaces_lock);
+    if (!interfaces)
+	interfaces = g_hash_table_new(NULL, NULL);
+    g_hash_table_insert(interfaces, interface, ipriv);
+    G_UNLOCK(interfaces_lock);
+}
+
+/* the private data of @interface, or NULL if the parser didn't make it */
+GladeInterfacePrivate *
+_glade_interface_get_private(GladeInterface *interface)
+{
+    GladeInterfacePrivate *ipriv = NULL;
+
+    G_LOCK(interfaces_lock);
+    if (interfaces)
+	ipriv = g_hash_table_lookup(interfaces, interface);
+    G_UNLOCK(interfaces_lock);
+    return ipriv;
+}
+
 static void
 glade_parser_start_document(GladeParseState *state)
 {
@@ -468,6 +512,7 @@ glade_parser_start_document(GladeParseState *state)
     state->content = g_string_sized_new(128);
 
     state->interface = g_new0(GladeInterface, 1);
+    glade_interface_register(state->interface);
     state->interface->names = g_hash_table_new(g_str_hash, g_str_equal);
     state->interface->strings = g_hash_table_new_full(g_str_hash,
 						      g_str_equal,
@@ -1149,23 +1194,65 @@ widget_info_free(GladeWidgetInfo *info)
 }
 
 /**
- * glade_interface_destroy
+ * glade_interface_ref
+ * @interface: the GladeInterface structure.
+ *
+ * Adds a reference to a GladeInterface, which must have been made by
+ * glade_parser_parse_file() or glade_parser_parse_buffer().  One
+ * interface can be shared by any number of GladeXML objects (see
+ * glade_xml_new_from_interface()).  The first build indexes its
+ * signals, and the index is kept for later builds, so an interface
+ * should only be built from one thread at a time.
+ *
+ * Returns: @interface.
+ */
+GladeInterface *
+glade_interface_ref(GladeInterface *interface)
+{
+    GladeInterfacePrivate *ipriv;
+
+    g_return_val_if_fail(interface != NULL, NULL);
+    ipriv = _glade_interface_get_private(interface);
+    g_return_val_if_fail(ipriv != NULL, NULL);
+
+    g_atomic_int_inc(&ipriv->ref_count);
+    return interface;
+}
+
+/**
+ * glade_interface_unref
  * @interface: the GladeInterface structure.
  *
- * Frees a GladeInterface structure.
+ * Drops a reference to a GladeInterface, and frees it if that was the
+ * last one.
  */
 void
-glade_interface_destroy(GladeInterface *interface)
+glade_interface_unref(GladeInterface *interface)
 {
+    GladeInterfacePrivate *ipriv;
     gint i;
 
     g_return_if_fail(interface != NULL);
 
+    ipriv = _glade_interface_get_private(interface);
+    if (ipriv) {
+	if (!g_atomic_int_dec_and_test(&ipriv->ref_count))
+	    return;
+	G_LOCK(interfaces_lock);
+	g_hash_table_remove(interfaces, interface);
+	G_UNLOCK(interfaces_lock);
+    }
+
     /* free requirements */
     g_free(interface->requires);
 
-    for (i = 0; i < interface->n_toplevels; i++)
-	widget_info_free(interface->toplevels[i]);
+    /* the widget infos are in one block, unless the parse failed or
+     * the interface didn't come from the parser */
+    if (ipriv && ipriv->nodes)
+	g_free(ipriv->nodes);
+    else
+	for (i = 0; i < interface->n_toplevels; i++)
+	    widget_info_free(interface->toplevels[i]);
     g_free(interface->toplevels);
 
     g_hash_table_destroy(interface->names);
@@ -1174,9 +1261,320 @@ glade_interface_destroy(GladeInterface *interface)
      * of the strings. */
     g_hash_table_destroy(interface->strings);
 
+    if (ipriv) {
+	if (ipriv->index)
+	    _glade_interface_index_free(ipriv->index);
+	g_free(ipriv->filename);
+	g_free(ipriv);
+    }
+
     g_free(interface);
 }
 
+/**
+ * glade_interface_destroy
+ * @interface: the GladeInterface structure.
+ *
+ * Frees a GladeInterface structure.  This is the same as
+ * glade_interface_unref(), so an interface still used by GladeXML
+ * objects is only freed once they are done with it.
+ */
+void
+glade_interface_destroy(GladeInterface *interface)
+{
+    glade_interface_unref(interface);
+}
+
+/* GHashTable's layout is private, so estimate a node (key, value,
+ * hash and next pointer) and a bucket for each entry, plus the table
+ * itself */
+gsize
+_glade_hash_table_memory_size(GHashTable *hash)
+{
+    if (!hash)
+	return 0;
+    return 64 + g_hash_table_size(hash) * 5 * sizeof(gpointer);
+}
+
+void
+_glade_memory_stats_add(GladeMemoryStats *stats, GladeMemoryCategory category,
+			guint count, gsize bytes)
+{
+    stats->count[category] += count;
+    stats->bytes[category] += bytes;
+    stats->total_bytes += bytes;
+}
+
+static void
+properties_memory_stats(GladeProperty *properties, guint n_properties,
+			GladeMemoryStats *stats)
+{
+    if (properties)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_PROPERTIES, n_properties,
+				n_properties * sizeof(GladeProperty));
+}
+
+static void
+widget_info_memory_stats(GladeWidgetInfo *info, GladeMemoryStats *stats)
+{
+    guint i;
+
+    _glade_memory_stats_add(stats, GLADE_MEMORY_WIDGET_INFOS, 1,
+			    sizeof(GladeWidgetInfo) +
+			    info->n_children * sizeof(GladeChildInfo));
+    properties_memory_stats(info->properties, info->n_properties, stats);
+    properties_memory_stats(info->atk_props, info->n_atk_props, stats);
+    _glade_memory_stats_add(stats, GLADE_MEMORY_SIGNALS, info->n_signals,
+			    info->n_signals * sizeof(GladeSignalInfo));
+    _glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+			    info->n_atk_actions * sizeof(GladeAtkActionInfo) +
+			    info->n_relations * sizeof(GladeAtkRelationInfo) +
+			    info->n_accels * sizeof(GladeAccelInfo));
+
+    for (i = 0; i < info->n_children; i++) {
+	properties_memory_stats(info->children[i].properties,
+				info->children[i].n_properties, stats);
+	widget_info_memory_stats(info->children[i].child, stats);
+    }
+}
+
+static void
+string_memory_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    _glade_memory_stats_add(user_data, GLADE_MEMORY_STRINGS, 1,
+			    strlen(key) + 1);
+}
+
+static void
+hash_table_memory_stats(GHashTable *hash, GladeMemoryStats *stats)
+{
+    if (hash)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_HASH_TABLES,
+				g_hash_table_size(hash),
+				_glade_hash_table_memory_size(hash));
+}
+
+/* add the memory held by @interface, and by its index if it has one,
+ * to @stats */
+void
+_glade_interface_add_memory_stats(GladeInterface *interface,
+				  GladeMemoryStats *stats)
+{
+    GladeInterfacePrivate *ipriv = _glade_interface_get_private(interface);
+    GladeInterfaceIndex *index = ipriv ? ipriv->index : NULL;
+    guint i;
+
+    _glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+			    sizeof(GladeInterface) +
+			    (ipriv ? sizeof(GladeInterfacePrivate) : 0) +
+			    interface->n_requires * sizeof(gchar *) +
+			    interface->n_toplevels * sizeof(GladeWidgetInfo *));
+    if (ipriv && ipriv->filename)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_STRINGS, 1,
+				strlen(ipriv->filename) + 1);
+    for (i = 0; i < interface->n_toplevels; i++)
+	widget_info_memory_stats(interface->toplevels[i], stats);
+
+    g_hash_table_foreach(interface->strings, string_memory_stats, stats);
+    hash_table_memory_stats(interface->names, stats);
+    hash_table_memory_stats(interface->strings, stats);
+
+    if (index) {
+	/* the index refers to the signals counted above, so only
+	 * count its bytes */
+	_glade_memory_stats_add(stats, GLADE_MEMORY_SIGNALS, 0,
+				index->n_signals * sizeof(GladeSignalData) +
+				index->n_handlers * sizeof(GladeHandlerSignals));
+	_glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+				sizeof(GladeInterfaceIndex));
+	hash_table_memory_stats(index->handler_hash, stats);
+    }
+}
+
+/**
+ * glade_interface_get_memory_stats
+ * @interface: the GladeInterface structure.
+ * @stats: the structure to fill in.
+ *
+ * Reports how much memory @interface holds, and how many items of
+ * each kind make it up.  The figures leave out the overhead of the
+ * memory allocator, and those for hash tables are estimates.
+ */
+void
+glade_interface_get_memory_stats(GladeInterface *interface,
+				 GladeMemoryStats *stats)
+{
+    g_return_if_fail(interface != NULL);
+    g_return_if_fail(stats != NULL);
+
+    memset(stats, 0, sizeof(GladeMemoryStats));
+    _glade_interface_add_memory_stats(interface, stats);
+}
+
+/* packing an interface.  The parser allocates every GladeWidgetInfo,
+ * and every array of properties, signals and so on, separately.  Once
+ * the parse is done, they are moved into one block: the infos first,
+ * in document order, then flat arrays of each kind of record shared by
+ * all of them.  The structures and their pointers are unchanged, but
+ * building the interface walks memory in order, and a widget's
+ * position in the document is its offset from the first info. */
+
+typedef struct {
+    guint n_nodes;
+    guint n_properties;
+    guint n_signals;
+    guint n_actions;
+    guint n_relations;
+    guint n_accels;
+    guint n_children;
+} PackCounts;
+
+typedef struct {
+    GHashTable *names;
+    GladeWidgetInfo *nodes;
+    guint n_nodes;
+    gchar *properties;
+    gchar *signals;
+    gchar *actions;
+    gchar *relations;
+    gchar *accels;
+    gchar *children;
+} PackState;
+
+static void
+pack_count(GladeWidgetInfo *info, PackCounts *counts)
+{
+    guint i;
+
+    counts->n_nodes++;
+    counts->n_properties += info->n_properties + info->n_atk_props;
+    counts->n_signals += info->n_signals;
+    counts->n_actions += info->n_atk_actions;
+    counts->n_relations += info->n_relations;
+    counts->n_accels += info->n_accels;
+    counts->n_children += info->n_children;
+    for (i = 0; i < info->n_children; i++) {
+	counts->n_properties += info->children[i].n_properties;
+	if (info->children[i].child)
+	    pack_count(info->children[i].child, counts);
+    }
+}
+
+/* reserve room for @n items of @size bytes at the end of a block of
+ * *@block_size bytes, and return their offset */
+static gsize
+pack_reserve(gsize *block_size, guint n, gsize size)
+{
+    gsize offset = (*block_size + G_MEM_ALIGN - 1) & ~(gsize)(G_MEM_ALIGN - 1);
+
+    *block_size = offset + n * size;
+    return offset;
+}
+
+/* move the @n items of @size bytes at @array to *@cursor, and advance
+ * it past them */
+static gpointer
+pack_array(gpointer array, guint n, gsize size, gchar **cursor)
+{
+    gpointer packed;
+
+    if (n == 0) {
+	g_free(array);
+	return NULL;
+    }
+    packed = *cursor;
+    memcpy(packed, array, n * size);
+    g_free(array);
+    *cursor += n * size;
+    return packed;
+}
+
+static GladeWidgetInfo *
+pack_widget(GladeWidgetInfo *info, GladeWidgetInfo *parent, PackState *state)
+{
+    GladeWidgetInfo *node = &state->nodes[state->n_nodes++];
+    guint i;
+
+    *node = *info;
+    g_free(info);
+    node->parent = parent;
+
+    /* later widgets of the same name replace earlier ones, as when
+     * parsing */
+    if (node->name)
+	g_hash_table_insert(state->names, node->name, node);
+
+    node->properties = pack_array(node->properties, node->n_properties,
+				  sizeof(GladeProperty), &state->properties);
+    node->atk_props = pack_array(node->atk_props, node->n_atk_props,
+				 sizeof(GladeProperty), &state->properties);
+    node->signals = pack_array(node->signals, node->n_signals,
+			       sizeof(GladeSignalInfo), &state->signals);
+    node->atk_actions = pack_array(node->atk_actions, node->n_atk_actions,
+				   sizeof(GladeAtkActionInfo), &state->actions);
+    node->relations = pack_array(node->relations, node->n_relations,
+				 sizeof(GladeAtkRelationInfo),
+				 &state->relations);
+    node->accels = pack_array(node->accels, node->n_accels,
+			      sizeof(GladeAccelInfo), &state->accels);
+    node->children = pack_array(node->children, node->n_children,
+				sizeof(GladeChildInfo), &state->children);
+
+    for (i = 0; i < node->n_children; i++) {
+	GladeChildInfo *child = &node->children[i];
+
+	child->properties = pack_array(child->properties, child->n_properties,
+				       sizeof(GladeProperty),
+				       &state->properties);
+	if (child->child)
+	    child->child = pack_widget(child->child, node, state);
+    }
+    return node;
+}
+
+static void
+glade_interface_pack(GladeInterface *interface)
+{
+    GladeInterfacePrivate *ipriv = _glade_interface_get_private(interface);
+    PackCounts counts = { 0 };
+    PackState state = { 0 };
+    gsize size = 0, properties, signals, actions, relations, accels, children;
+    gchar *block;
+    guint i;
+
+    for (i = 0; i < interface->n_toplevels; i++)
+	pack_count(interface->toplevels[i], &counts);
+
+    pack_reserve(&size, counts.n_nodes, sizeof(GladeWidgetInfo));
+    properties = pack_reserve(&size, counts.n_properties,
+			      sizeof(GladeProperty));
+    signals = pack_reserve(&size, counts.n_signals, sizeof(GladeSignalInfo));
+    actions = pack_reserve(&size, counts.n_actions,
+			   sizeof(GladeAtkActionInfo));
+    relations = pack_reserve(&size, counts.n_relations,
+			     sizeof(GladeAtkRelationInfo));
+    accels = pack_reserve(&size, counts.n_accels, sizeof(GladeAccelInfo));
+    children = pack_reserve(&size, counts.n_children, sizeof(GladeChildInfo));
+
+    block = g_malloc(MAX(size, 1));
+    state.names = interface->names;
+    state.nodes = (GladeWidgetInfo *)block;
+    state.properties = block + properties;
+    state.signals = block + signals;
+    state.actions = block + actions;
+    state.relations = block + relations;
+    state.accels = block + accels;
+    state.children = block + children;
+    for (i = 0; i < interface->n_toplevels; i++)
+	interface->toplevels[i] = pack_widget(interface->toplevels[i], NULL,
+					      &state);
+
+    ipriv->nodes = state.nodes;
+    ipriv->n_nodes = state.n_nodes;
+    /* built here, before the interface can be shared between threads */
+    ipriv->index = _glade_interface_index_new(ipriv->nodes, ipriv->n_nodes);
+}
+
 /**
  * glade_parser_parse_file
  * @file: the filename of the glade XML file.
@@ -1211,11 +1609,13 @@ glade_parser_parse_file(const gchar *file, const gchar *domain)
     else
 	state.domain = textdomain(NULL);
 
+    GLADE_TRACE_BEGIN("glade_parser_parse_file", "parse", "file", file);
 #ifdef G_OS_WIN32
     cp_file = g_win32_locale_filename_from_utf8(file);
 
     if (cp_file == NULL) {
 	g_warning("could not get system codepage name of '%s'", file);
+	GLADE_TRACE_END("glade_parser_parse_file", "parse");
 	return NULL;
     }
 
@@ -1225,6 +1625,7 @@ glade_parser_parse_file(const gchar *file, const gchar *domain)
 #else
     rc = xmlSAXUserParseFile(&glade_parser, &state, file);
 #endif
+    GLADE_TRACE_END("glade_parser_parse_file", "parse");
 
     if (rc < 0) {
 	g_warning("document not well formed");
@@ -1238,6 +1639,8 @@ glade_parser_parse_file(const gchar *file, const gchar *domain)
 	    glade_interface_destroy(state.interface);
 	return NULL;
     }
+    glade_interface_pack(state.interface);
+    _glade_interface_get_private(state.interface)->filename = g_strdup(file);
     return state.interface;
 }
 
@@ -1260,6 +1663,7 @@ GladeInterface *
 glade_parser_parse_buffer(const gchar *buffer, gint len, const gchar *domain)
 {
     GladeParseState state = { 0 };
+    int rc;
 
     state.interface = NULL;
     if (domain)
@@ -1267,7 +1671,11 @@ glade_parser_parse_buffer(const gchar *buffer, gint len, const gchar *domain)
     else
 	state.domain = textdomain(NULL);
 
-    if (xmlSAXUserParseMemory(&glade_parser, &state, buffer, len) < 0) {
+    GLADE_TRACE_BEGIN("glade_parser_parse_buffer", "parse", NULL, NULL);
+    rc = xmlSAXUserParseMemory(&glade_parser, &state, buffer, len);
+    GLADE_TRACE_END("glade_parser_parse_buffer", "parse");
+
+    if (rc < 0) {
 	g_warning("document not well formed!");
 	if (state.interface)
 	    glade_interface_destroy (state.interface);
@@ -1279,6 +1687,7 @@ glade_parser_parse_buffer(const gchar *buffer, gint len, const gchar *domain)
 	    glade_interface_destroy(state.interface);
 	return NULL;
     }
+    glade_interface_pack(state.interface);
     return state.interface;
 }
 
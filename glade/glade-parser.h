@@ -119,10 +119,33 @@ GladeInterface *glade_parser_parse_file   (const gchar *file,
 GladeInterface *glade_parser_parse_buffer (const gchar *buffer, gint len,
 					   const gchar *domain);
 void            glade_interface_destroy   (GladeInterface *interface);
+GladeInterface *glade_interface_ref       (GladeInterface *interface);
+void            glade_interface_unref     (GladeInterface *interface);
 
 void            glade_interface_dump      (GladeInterface *interface,
 					   const gchar *filename);
 
+/* memory held by an interface or a GladeXML object */
+typedef enum {
+    GLADE_MEMORY_WIDGET_INFOS,
+    GLADE_MEMORY_PROPERTIES,
+    GLADE_MEMORY_STRINGS,
+    GLADE_MEMORY_SIGNALS,
+    GLADE_MEMORY_HASH_TABLES,
+    GLADE_MEMORY_OTHER,
+    GLADE_MEMORY_N_CATEGORIES
+} GladeMemoryCategory;
+
+typedef struct _GladeMemoryStats GladeMemoryStats;
+struct _GladeMemoryStats {
+    gsize bytes[GLADE_MEMORY_N_CATEGORIES];
+    guint count[GLADE_MEMORY_N_CATEGORIES];
+    gsize total_bytes;
+};
+
+void glade_interface_get_memory_stats (GladeInterface *interface,
+				       GladeMemoryStats *stats);
+
 G_END_DECLS
 
 #endif
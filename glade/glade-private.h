@@ -27,19 +27,47 @@
 #include <glade/glade-xml.h>
 #include <glade/glade-parser.h>
 
+typedef struct _GladeInterfaceIndex GladeInterfaceIndex;
+typedef struct _GladeWidgetData GladeWidgetData;
+
 struct _GladeXMLPrivate {
     GladeInterface *tree; /* the tree for this GladeXML */
 
     GtkTooltips *tooltips; /* if not NULL, holds all tooltip info */
 
-    /* hash tables of widgets.  The keys are stored as widget data,
-     * and get freed with those widgets. */
+    /* the widgets by name, as GladeWidgetData.  The keys are owned by
+     * the interface. */
     GHashTable *name_hash;
+
+    /* the bookkeeping of the widgets built and not destroyed yet,
+     * newest first, and their number */
+    GladeWidgetData *widget_data;
+    guint n_live_widgets;
+
+    /* the toplevel being destroyed.  Until it is gone, the widgets
+     * destroyed with it are only marked and moved to dead_widget_data,
+     * and then they are all dropped at once (see
+     * glade_xml_toplevel_destroy()). */
+    GtkWidget *dying;
+    GladeWidgetData *dead_widget_data;
 	
-    /* hash table of signals.  The Data is a GList of GladeSignalData
-     * structures which get freed when the GladeXML object is
-     * destroyed */
-    GHashTable *signals;
+    /* the widgets built from the interface, by their position in the
+     * interface's index (see GladeInterfaceIndex) less first_widget.
+     * As the widgets are indexed in document order, the ones under the
+     * root are a contiguous range of them.  NULL for widgets that
+     * weren't built or have been destroyed. */
+    GladeInterfaceIndex *index;
+    GtkWidget **widgets;
+    guint first_widget;
+    guint n_widgets;
+
+    /* widgets built from GladeWidgetInfos that aren't in the index
+     * or under the root (a module may build some itself), and their
+     * signals.  The signal_widget of these signals is the number of
+     * widgets in the index plus their position in extra_widgets.  NULL
+     * if there are none. */
+    GPtrArray *extra_widgets;
+    GHashTable *extra_signals; /* handler name -> GArray of GladeSignalData */
 
     /* the current toplevel being built */
     GtkWindow *toplevel;
@@ -57,16 +85,115 @@ struct _GladeXMLPrivate {
      * be set earlier because the value widget hadn't been created
      * yet). */
     GList *deferred_props;
+
+    /* widgets whose notifications are held back until the whole
+     * interface has been built (GLADE_BUILD_FREEZE_NOTIFY), and the
+     * toplevels whose gtk_widget_show() waits for the same point.
+     * NULL when not building in that mode. */
+    GPtrArray *frozen_widgets;
+    GList *deferred_shows;
+
+    /* GladeWidgetInfos whose accessibility info hasn't been applied
+     * yet (GLADE_BUILD_DEFER_ATK) */
+    GList *pending_atk;
+
+    /* with GLADE_BUILD_COMPACT, the pool holding the widget names and
+     * signal information once tree has been released (and the index
+     * is then owned by the GladeXML), and its size.  compact_pending is
+     * set if that has to wait for pending_atk to be applied. */
+    GStringChunk *strings;
+    gsize strings_size;
+    gboolean compact_pending;
+
+    /* the options for this object, from glade_get_build_flags() when
+     * it was created */
+    GladeBuildFlags build_flags;
+};
+
+/* set as the data of each widget a GladeXML builds, which holds a weak
+ * reference to the widget so it can forget the widget when it is
+ * destroyed.  They are freed when the widget is, or with the
+ * GladeXML. */
+struct _GladeWidgetData {
+    GladeXML *xml;
+    const gchar *name;     /* owned by the interface */
+    GtkWidget *widget;
+    guint slot;            /* the widget's position in widgets, followed
+			    * by extra_widgets, plus one, or 0 */
+    guint destroyed : 1;
+    guint toplevel : 1;    /* glade_xml_toplevel_destroy() is connected */
+    GladeWidgetData *next;
+    GladeWidgetData *prev; /* only while in widget_data */
 };
 
 typedef struct _GladeSignalData GladeSignalData;
 struct _GladeSignalData {
-    GObject *signal_object;
-    char *signal_name;
-    char *connect_object; /* or NULL if there is none */
+    guint signal_widget; /* the widget's position in the index */
+    const char *signal_name;
+    const char *connect_object; /* or NULL if there is none */
     gboolean signal_after;
 };
 
+typedef struct _GladeHandlerSignals GladeHandlerSignals;
+struct _GladeHandlerSignals {
+    const char *handler_name;
+    GladeSignalData *signals;
+    guint n_signals;
+};
+
+/* an index of a GladeInterface, built by the parser along with it and
+ * shared by every GladeXML built from it */
+struct _GladeInterfaceIndex {
+    /* all widgets in the interface in document order: the packed
+     * GladeWidgetInfos of the interface, which the index doesn't own */
+    GladeWidgetInfo *widgets;
+    guint32 n_widgets;
+
+    /* all signals, grouped by handler.  Each handler's signals are
+     * a contiguous run of the signals array. */
+    GladeSignalData *signals;
+    guint n_signals;
+    GladeHandlerSignals *handlers;
+    guint n_handlers;
+    GHashTable *handler_hash; /* handler name -> GladeHandlerSignals */
+};
+
+/* whether @info is one of the widgets of @index, and its position */
+#define GLADE_INDEX_HAS_WIDGET(index, info) \
+    ((index)->widgets != NULL && (info) >= (index)->widgets && \
+     (info) < (index)->widgets + (index)->n_widgets)
+#define GLADE_INDEX_WIDGET_POSITION(index, info) \
+    ((guint32)((info) - (index)->widgets))
+
+/* libglade's private data about a GladeInterface made by the parser.
+ * GladeInterface is a public structure, so this is kept in a table
+ * rather than allocated with it (see _glade_interface_get_private()). */
+typedef struct _GladeInterfacePrivate GladeInterfacePrivate;
+struct _GladeInterfacePrivate {
+    GladeInterfaceIndex *index;
+    gint ref_count;
+    gchar *filename; /* the file it was parsed from, or NULL */
+    /* the widget infos in document order, in one block with the arrays
+     * they point to.  NULL if the parse failed. */
+    GladeWidgetInfo *nodes;
+    guint32 n_nodes;
+};
+
+/* glade-parser.c */
+GladeInterfacePrivate *_glade_interface_get_private (GladeInterface *interface);
+gsize _glade_hash_table_memory_size     (GHashTable *hash);
+void  _glade_memory_stats_add           (GladeMemoryStats *stats,
+					 GladeMemoryCategory category,
+					 guint count, gsize bytes);
+void  _glade_interface_add_memory_stats (GladeInterface *interface,
+					 GladeMemoryStats *stats);
+
+/* glade-xml.c */
+gdouble              _glade_get_time             (void);
+GladeInterfaceIndex *_glade_interface_index_new  (GladeWidgetInfo *nodes,
+						  guint n_nodes);
+void                 _glade_interface_index_free (GladeInterfaceIndex *index);
+
 typedef struct _GladeDeferredProperty GladeDeferredProperty;
 struct _GladeDeferredProperty {
     const gchar *target_name;
@@ -85,10 +212,60 @@ struct _GladeDeferredProperty {
 };
 
 typedef enum {
-    GLADE_DEBUG_PARSER = 1 << 0,
-    GLADE_DEBUG_BUILD  = 1 << 1
+    GLADE_DEBUG_PARSER   = 1 << 0,
+    GLADE_DEBUG_BUILD    = 1 << 1,
+    GLADE_DEBUG_HANDLERS = 1 << 2, /* time signal handlers */
+    GLADE_DEBUG_PROFILE  = 1 << 3  /* print build profile at exit */
 } GladeDebugFlag;
 
+/* glade-cache.c */
+GdkPixbuf *_glade_pixbuf_cache_load(const gchar *filename, GError **error);
+void       _glade_pixbuf_cache_prefetch(const gchar *filename);
+gboolean   _glade_colormap_get_color(GdkColormap *colormap,
+				     const gchar *spec, GdkColor *colour);
+
+typedef void (* GladeLazyImageFunc) (GtkWidget *widget, GdkPixbuf *pixbuf,
+				     gpointer data);
+GdkPixbuf   *_glade_pixbuf_placeholder_new      (const gchar *filename);
+gboolean     _glade_pixbuf_is_placeholder       (GdkPixbuf *pixbuf);
+void         _glade_lazy_image_add              (GtkWidget *widget,
+						 const gchar *filename,
+						 GladeLazyImageFunc func,
+						 gpointer data);
+void         _glade_lazy_image_set_property     (GtkWidget *widget,
+						 GdkPixbuf *pixbuf,
+						 gpointer data);
+
+/* glade-profile.c */
+extern gboolean _glade_profile_enabled;
+void    _glade_profile_add          (GladeProfilePhase phase,
+				     const gchar *class_name, gdouble time);
+void    _glade_profile_count_widget (const gchar *class_name);
+gdouble _glade_profile_total        (void);
+
+/* set start to the current time if profiling, and add the time since
+ * then to phase at the end */
+#define GLADE_PROFILE_START(start) \
+    ((start) = _glade_profile_enabled ? _glade_get_time() : -1)
+#define GLADE_PROFILE_END(start, phase, class_name) G_STMT_START { \
+    if ((start) >= 0) \
+        _glade_profile_add(GLADE_PROFILE_##phase, (class_name), \
+                           _glade_get_time() - (start)); } G_STMT_END
+
+extern gboolean _glade_trace_enabled;
+void _glade_trace_event (gchar phase, const gchar *name,
+			 const gchar *category, const gchar *arg_name,
+			 const gchar *arg_value);
+
+/* begin and end a span of the trace written by glade_trace_start() */
+#define GLADE_TRACE_BEGIN(name, category, arg_name, arg_value) G_STMT_START { \
+    if (_glade_trace_enabled) \
+        _glade_trace_event('B', (name), (category), (arg_name), \
+                           (arg_value)); } G_STMT_END
+#define GLADE_TRACE_END(name, category) G_STMT_START { \
+    if (_glade_trace_enabled) \
+        _glade_trace_event('E', (name), (category), NULL, NULL); } G_STMT_END
+
 extern guint _glade_debug_flags;
 #ifdef DEBUG
 #  define GLADE_NOTE(type, action)  G_STMT_START { \
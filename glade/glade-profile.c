@@ -0,0 +1,368 @@
+/* -*- Mode: C; c-basic-offset: 4 -*-
+ * libglade - a library for building interfaces from XML files at runtime
+ * Copyright (C) 1998-2002  James Henstridge <james@daa.com.au>
+ *
+ * glade-profile.c: profiling and tracing of interface building.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA  02111-1307, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <glade/glade-xml.h>
+#include <glade/glade-private.h>
+
+/* the counters are only touched while profiling is on, which the
+ * GLADE_PROFILE_START() and GLADE_PROFILE_END() macros check before
+ * reading the clock.  Class names are interned, so the statistics
+ * handed out stay valid after a reset. */
+
+gboolean _glade_profile_enabled = FALSE;
+
+/* fails to compile if the phases outgrow the slots in GladeProfileStats */
+typedef char glade_profile_phases_fit[GLADE_PROFILE_N_PHASES <=
+				      GLADE_PROFILE_MAX_PHASES ? 1 : -1];
+
+static GladeProfileStats profile_totals = { NULL };
+static GHashTable *profile_classes = NULL;
+
+static const gchar *const phase_names[GLADE_PROFILE_N_PHASES] = {
+    "parse",
+    "require",
+    "lookup type",
+    "properties",
+    "construct",
+    "custom props",
+    "children",
+    "signals",
+    "atk",
+    "build"
+};
+
+static GladeProfileStats *
+get_class_stats(const gchar *class_name)
+{
+    GladeProfileStats *stats;
+
+    if (!profile_classes)
+	profile_classes = g_hash_table_new(g_str_hash, g_str_equal);
+
+    stats = g_hash_table_lookup(profile_classes, class_name);
+    if (!stats) {
+	stats = g_new0(GladeProfileStats, 1);
+	stats->class_name = g_intern_string(class_name);
+	g_hash_table_insert(profile_classes, (gchar *)stats->class_name,
+			    stats);
+    }
+    return stats;
+}
+
+static gdouble
+stats_total(const GladeProfileStats *stats)
+{
+    gdouble total = 0;
+    gint i;
+
+    for (i = 0; i < GLADE_PROFILE_N_PHASES; i++)
+	total += stats->time[i];
+    return total;
+}
+
+/* add @time seconds spent in @phase to the totals and, if it is not
+ * NULL, to the statistics for @class_name */
+void
+_glade_profile_add(GladeProfilePhase phase, const gchar *class_name,
+		   gdouble time)
+{
+    profile_totals.time[phase] += time;
+    if (class_name)
+	get_class_stats(class_name)->time[phase] += time;
+}
+
+/* the time counted in all phases so far, so that a phase which may
+ * contain others can leave them out */
+gdouble
+_glade_profile_total(void)
+{
+    return stats_total(&profile_totals);
+}
+
+void
+_glade_profile_count_widget(const gchar *class_name)
+{
+    profile_totals.n_widgets++;
+    get_class_stats(class_name)->n_widgets++;
+}
+
+static void
+append_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    GladeProfileStats *stats = value;
+    GArray *array = user_data;
+
+    /* skip classes not seen since the last reset */
+    if (stats->n_widgets > 0 || stats_total(stats) > 0)
+	g_array_append_vals(array, stats, 1);
+}
+
+static gint
+stats_compare(gconstpointer a, gconstpointer b)
+{
+    gdouble total_a = stats_total(a), total_b = stats_total(b);
+
+    if (total_a > total_b)
+	return -1;
+    return total_a < total_b;
+}
+
+/**
+ * glade_get_profile_stats:
+ * @totals: location to store the totals over all classes, or %NULL.
+ * @n_classes: location to store the number of classes returned.
+ *
+ * Gets the time spent in each phase of building interfaces since
+ * profiling was turned on with %GLADE_BUILD_PROFILE, or since the
+ * last glade_reset_profile_stats().  The totals include phases that
+ * do not belong to a widget class, such as parsing and loading
+ * modules.  The build phase is the time spent in widget build
+ * functions outside the other phases, such as all of the time in
+ * ones that don't use glade_standard_build_widget().  Only the first
+ * %GLADE_PROFILE_N_PHASES entries of the time arrays are used.
+ *
+ * Returns: a newly allocated array of statistics for each widget
+ * class built, slowest first.  Free it with g_free().
+ */
+GladeProfileStats *
+glade_get_profile_stats(GladeProfileStats *totals, guint *n_classes)
+{
+    GArray *array;
+
+    g_return_val_if_fail(n_classes != NULL, NULL);
+
+    if (totals)
+	*totals = profile_totals;
+
+    array = g_array_new(FALSE, FALSE, sizeof(GladeProfileStats));
+    if (profile_classes)
+	g_hash_table_foreach(profile_classes, append_stats, array);
+    if (array->len > 0)
+	qsort(array->data, array->len, sizeof(GladeProfileStats),
+	      stats_compare);
+
+    *n_classes = array->len;
+    return (GladeProfileStats *)g_array_free(array, FALSE);
+}
+
+static void
+print_stats(const gchar *name, const GladeProfileStats *stats)
+{
+    gint i;
+
+    g_print("%-24s %7u", name, stats->n_widgets);
+    for (i = 0; i < GLADE_PROFILE_N_PHASES; i++)
+	g_print(" %9.3f", stats->time[i] * 1000);
+    g_print(" %9.3f\n", stats_total(stats) * 1000);
+}
+
+/**
+ * glade_print_profile_stats:
+ *
+ * Prints the statistics returned by glade_get_profile_stats() as a
+ * table, in milliseconds.  If the LIBGLADE_DEBUG environment variable
+ * contains "profile", profiling is turned on by glade_init() and this
+ * is called when the program exits.
+ */
+void
+glade_print_profile_stats(void)
+{
+    GladeProfileStats totals, *classes;
+    guint n_classes, i;
+    gint phase;
+
+    classes = glade_get_profile_stats(&totals, &n_classes);
+
+    g_print("%-24s %7s", "class", "widgets");
+    for (phase = 0; phase < GLADE_PROFILE_N_PHASES; phase++)
+	g_print(" %9.9s", phase_names[phase]);
+    g_print(" %9s\n", "total");
+
+    for (i = 0; i < n_classes; i++)
+	print_stats(classes[i].class_name, &classes[i]);
+    print_stats("(all)", &totals);
+
+    g_free(classes);
+}
+
+static void
+reset_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    GladeProfileStats *stats = value;
+
+    stats->n_widgets = 0;
+    memset(stats->time, 0, sizeof(stats->time));
+}
+
+/**
+ * glade_reset_profile_stats:
+ *
+ * Sets all the counters returned by glade_get_profile_stats() back to
+ * zero.
+ */
+void
+glade_reset_profile_stats(void)
+{
+    reset_stats(NULL, &profile_totals, NULL);
+    if (profile_classes)
+	g_hash_table_foreach(profile_classes, reset_stats, NULL);
+}
+
+/* tracing.  Spans are written as they begin and end, in the Chrome
+ * trace event format, so that nesting in the viewer follows the
+ * widget hierarchy.  Image decoding can happen on worker threads, so
+ * writes are serialised and each thread gets its own track. */
+
+gboolean _glade_trace_enabled = FALSE;
+
+static GStaticMutex trace_mutex = G_STATIC_MUTEX_INIT;
+static GStaticPrivate trace_thread_id = G_STATIC_PRIVATE_INIT;
+static FILE *trace_file = NULL;
+static gdouble trace_start_time = 0;
+static guint trace_n_threads = 0;
+
+static void
+trace_write_string(const gchar *string)
+{
+    const gchar *p;
+
+    fputc('"', trace_file);
+    for (p = string; *p; p++) {
+	if (*p == '"' || *p == '\\')
+	    fprintf(trace_file, "\\%c", *p);
+	else if ((guchar)*p < 0x20)
+	    fprintf(trace_file, "\\u%04x", (guchar)*p);
+	else
+	    fputc(*p, trace_file);
+    }
+    fputc('"', trace_file);
+}
+
+/* write a begin ('B') or end ('E') event for the span @name, with an
+ * optional string argument */
+void
+_glade_trace_event(gchar phase, const gchar *name, const gchar *category,
+		   const gchar *arg_name, const gchar *arg_value)
+{
+    gdouble now = _glade_get_time();
+    guint tid;
+
+    g_static_mutex_lock(&trace_mutex);
+    if (!trace_file) {
+	g_static_mutex_unlock(&trace_mutex);
+	return;
+    }
+
+    tid = GPOINTER_TO_UINT(g_static_private_get(&trace_thread_id));
+    if (tid == 0) {
+	tid = ++trace_n_threads;
+	g_static_private_set(&trace_thread_id, GUINT_TO_POINTER(tid), NULL);
+    }
+
+    fputs(",\n{\"name\":", trace_file);
+    trace_write_string(name ? name : "");
+    fputs(",\"cat\":", trace_file);
+    trace_write_string(category);
+    fprintf(trace_file, ",\"ph\":\"%c\",\"ts\":%.1f,\"pid\":1,\"tid\":%u",
+	    phase, (now - trace_start_time) * G_USEC_PER_SEC, tid);
+    if (arg_name && arg_value) {
+	fputs(",\"args\":{", trace_file);
+	trace_write_string(arg_name);
+	fputc(':', trace_file);
+	trace_write_string(arg_value);
+	fputc('}', trace_file);
+    }
+    fputc('}', trace_file);
+    g_static_mutex_unlock(&trace_mutex);
+}
+
+/**
+ * glade_trace_start:
+ * @filename: the file to write the trace to.
+ *
+ * Starts writing a trace of parsing and building interfaces to
+ * @filename, in the JSON format read by the Chrome trace viewer.  It
+ * has spans for parsing, loading modules, each widget built (named
+ * after the widget, and nested like the widgets), custom properties,
+ * image loading and signal autoconnection.  If a trace is already
+ * being written, it is finished first.
+ *
+ * If the LIBGLADE_TRACE environment variable is set, glade_init()
+ * starts a trace to the file it names, and it is finished when the
+ * program exits.
+ *
+ * Returns: %TRUE if the file could be opened.
+ */
+gboolean
+glade_trace_start(const gchar *filename)
+{
+    FILE *file;
+
+    g_return_val_if_fail(filename != NULL, FALSE);
+
+    glade_trace_stop();
+
+    file = g_fopen(filename, "w");
+    if (!file) {
+	g_warning("could not open trace file '%s'", filename);
+	return FALSE;
+    }
+
+    g_static_mutex_lock(&trace_mutex);
+    trace_file = file;
+    trace_start_time = _glade_get_time();
+    fputs("[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+	  "\"args\":{\"name\":", trace_file);
+    trace_write_string(g_get_prgname() ? g_get_prgname() : "libglade");
+    fputs("}}", trace_file);
+    _glade_trace_enabled = TRUE;
+    g_static_mutex_unlock(&trace_mutex);
+
+    return TRUE;
+}
+
+/**
+ * glade_trace_stop:
+ *
+ * Finishes the trace started with glade_trace_start(), if any.
+ */
+void
+glade_trace_stop(void)
+{
+    g_static_mutex_lock(&trace_mutex);
+    if (trace_file) {
+	fputs("\n]\n", trace_file);
+	fclose(trace_file);
+	trace_file = NULL;
+    }
+    _glade_trace_enabled = FALSE;
+    g_static_mutex_unlock(&trace_mutex);
+}
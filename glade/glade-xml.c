@@ -37,13 +37,17 @@
 #  include <libintl.h>
 #endif
 
-static const gchar *glade_xml_tree_key     = "GladeXML::tree";
-static GQuark       glade_xml_tree_id      = 0;
-static const gchar *glade_xml_name_key     = "GladeXML::name";
-static GQuark       glade_xml_name_id      = 0;
+static const gchar *glade_xml_data_key     = "GladeXML::data";
+static GQuark       glade_xml_data_id      = 0;
 static const gchar *glade_xml_tooltips_key = "GladeXML::tooltips";
 static GQuark       glade_xml_tooltips_id  = 0;
 
+static GladeBuildFlags build_flags = 0;
+
+/* time spent in glade_xml_build_widget() for the children of the
+ * container being built, while profiling */
+static gdouble profile_child_time = 0;
+
 G_DEFINE_TYPE (GladeXML, glade_xml, G_TYPE_OBJECT)
 #define GLADE_XML_GET_PRIVATE(object) \
 	(G_TYPE_INSTANCE_GET_PRIVATE ((object), GLADE_TYPE_XML, GladeXMLPrivate))
@@ -52,6 +56,8 @@ static void glade_xml_finalize(GObject *object);
 
 static void glade_xml_build_interface(GladeXML *xml, GladeInterface *iface,
 				      const char *root);
+static void glade_xml_compact(GladeXML *self);
+static void glade_xml_forget_destroyed(GladeXML *self);
 
 static GType glade_xml_real_lookup_type(GladeXML*self, const char *gtypename);
 
@@ -64,8 +70,7 @@ glade_xml_class_init (GladeXMLClass *class)
 
     class->lookup_type = glade_xml_real_lookup_type;
 
-    glade_xml_tree_id = g_quark_from_static_string(glade_xml_tree_key);
-    glade_xml_name_id = g_quark_from_static_string(glade_xml_name_key);
+    glade_xml_data_id = g_quark_from_static_string(glade_xml_data_key);
     glade_xml_tooltips_id = g_quark_from_static_string(glade_xml_tooltips_key);
 
     /* make sure libglade is initialised */
@@ -86,12 +91,28 @@ glade_xml_init (GladeXML *self)
     gtk_tooltips_enable(priv->tooltips);
     g_object_ref_sink(priv->tooltips);
     priv->name_hash = g_hash_table_new(g_str_hash, g_str_equal);
-    priv->signals = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->widget_data = NULL;
+    priv->n_live_widgets = 0;
+    priv->dead_widget_data = NULL;
+    priv->dying = NULL;
+    priv->index = NULL;
+    priv->widgets = NULL;
+    priv->first_widget = 0;
+    priv->n_widgets = 0;
+    priv->extra_widgets = NULL;
+    priv->extra_signals = NULL;
     priv->toplevel = NULL;
     priv->accel_group = NULL;
     priv->default_widget = NULL;
     priv->focus_widget = NULL;
     priv->deferred_props = NULL;
+    priv->frozen_widgets = NULL;
+    priv->deferred_shows = NULL;
+    priv->pending_atk = NULL;
+    priv->strings = NULL;
+    priv->strings_size = 0;
+    priv->compact_pending = FALSE;
+    priv->build_flags = build_flags;
 }
 
 /**
@@ -138,11 +159,14 @@ glade_xml_construct (GladeXML *self, const char *fname, const char *root,
 		     const char *domain)
 {
     GladeInterface *iface;
+    gdouble start;
 
     g_return_val_if_fail(self != NULL, FALSE);
     g_return_val_if_fail(fname != NULL, FALSE);
 
+    GLADE_PROFILE_START(start);
     iface = glade_parser_parse_file(fname, domain);
+    GLADE_PROFILE_END(start, PARSE, NULL);
 
     if (!iface)
 	return FALSE;
@@ -177,11 +201,14 @@ glade_xml_construct_from_buffer (GladeXML *self, const char *buffer, int size,
 					  const char *domain)
 {
     GladeInterface *iface;
+    gdouble start;
 
     g_return_val_if_fail(self != NULL, FALSE);
     g_return_val_if_fail(self->priv->tree == NULL, FALSE);
 
+    GLADE_PROFILE_START(start);
     iface = glade_parser_parse_buffer(buffer, size, domain);
+    GLADE_PROFILE_END(start, PARSE, NULL);
 
     if (!iface)
 	return FALSE;
@@ -226,6 +253,644 @@ glade_xml_new_from_buffer(const char *buffer, int size, const char *root,
     return self;
 }
 
+/**
+ * glade_xml_new_from_interface:
+ * @iface: the interface to build.
+ * @root: the widget node in @iface to start building from (or %NULL)
+ *
+ * Creates a new GladeXML object (and the corresponding widgets) from an
+ * interface parsed with glade_parser_parse_file() or
+ * glade_parser_parse_buffer().  The GladeXML object holds a reference
+ * to @iface rather than a copy, so any number of them can be built from
+ * one parse of a file, and the memory for the interface is only needed
+ * once.  Relative file names in @iface are resolved against the file it
+ * was parsed from, if any.  Interfaces that weren't made by the parser
+ * can't be built this way.
+ *
+ * Returns: the newly created GladeXML object.
+ */
+GladeXML *
+glade_xml_new_from_interface(GladeInterface *iface, const char *root)
+{
+    GladeInterfacePrivate *ipriv;
+    GladeXML *self;
+
+    g_return_val_if_fail(iface != NULL, NULL);
+    ipriv = _glade_interface_get_private(iface);
+    g_return_val_if_fail(ipriv != NULL, NULL);
+
+    self = g_object_new(GLADE_TYPE_XML, NULL);
+    self->priv->tree = glade_interface_ref(iface);
+    self->filename = g_strdup(ipriv->filename);
+    glade_xml_build_interface(self, iface, root);
+
+    return self;
+}
+
+/* the interface index.  Rather than every GladeXML keeping a list of
+ * signal records per handler, the signals of an interface are
+ * gathered once, grouped by handler, and refer to widgets by their
+ * position in the document, which is their position among the packed
+ * widget infos of the interface.  A GladeXML then only needs an array
+ * of the widgets it built. */
+
+GladeInterfaceIndex *
+_glade_interface_index_new(GladeWidgetInfo *nodes, guint n_nodes)
+{
+    GladeInterfaceIndex *index;
+    GPtrArray *handler_order;
+    GHashTable *counts;
+    guint i, j, offset;
+
+    index = g_new0(GladeInterfaceIndex, 1);
+    index->widgets = nodes;
+    index->n_widgets = n_nodes;
+
+    handler_order = g_ptr_array_new();
+    counts = g_hash_table_new(g_str_hash, g_str_equal);
+    for (i = 0; i < index->n_widgets; i++) {
+	GladeWidgetInfo *info = &index->widgets[i];
+
+	for (j = 0; j < info->n_signals; j++) {
+	    const gchar *handler = info->signals[j].handler;
+	    guint count = GPOINTER_TO_UINT(g_hash_table_lookup(counts, handler));
+
+	    if (count == 0)
+		g_ptr_array_add(handler_order, (gpointer)handler);
+	    g_hash_table_insert(counts, (gpointer)handler,
+				GUINT_TO_POINTER(count + 1));
+	}
+    }
+
+    /* lay the handlers' runs of signals out one after the other */
+    index->n_handlers = handler_order->len;
+    index->handlers = g_new(GladeHandlerSignals, index->n_handlers);
+    index->handler_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    index->n_signals = 0;
+    for (i = 0; i < index->n_handlers; i++) {
+	GladeHandlerSignals *handler = &index->handlers[i];
+
+	handler->handler_name = g_ptr_array_index(handler_order, i);
+	handler->n_signals = GPOINTER_TO_UINT(
+	    g_hash_table_lookup(counts, handler->handler_name));
+	index->n_signals += handler->n_signals;
+	g_hash_table_insert(index->handler_hash,
+			    (gpointer)handler->handler_name, handler);
+    }
+    index->signals = g_new(GladeSignalData, index->n_signals);
+    offset = 0;
+    for (i = 0; i < index->n_handlers; i++) {
+	index->handlers[i].signals = index->signals + offset;
+	offset += index->handlers[i].n_signals;
+	/* counted up again as the signals are filled in */
+	index->handlers[i].n_signals = 0;
+    }
+
+    for (i = 0; i < index->n_widgets; i++) {
+	GladeWidgetInfo *info = &index->widgets[i];
+
+	for (j = 0; j < info->n_signals; j++) {
+	    GladeSignalInfo *sig = &info->signals[j];
+	    GladeHandlerSignals *handler;
+	    GladeSignalData *data;
+
+	    handler = g_hash_table_lookup(index->handler_hash, sig->handler);
+	    data = &handler->signals[handler->n_signals++];
+	    data->signal_widget = i;
+	    data->signal_name = sig->name;
+	    data->connect_object = sig->object;
+	    data->signal_after = sig->after;
+	}
+    }
+
+    g_hash_table_destroy(counts);
+    g_ptr_array_free(handler_order, TRUE);
+
+    return index;
+}
+
+void
+_glade_interface_index_free(GladeInterfaceIndex *index)
+{
+    g_free(index->signals);
+    g_free(index->handlers);
+    g_hash_table_destroy(index->handler_hash);
+    g_free(index);
+}
+
+/* the widget called @name, or NULL if there is none or it has been
+ * destroyed */
+static GtkWidget *
+glade_xml_lookup(GladeXML *self, const gchar *name)
+{
+    GladeWidgetData *data = g_hash_table_lookup(self->priv->name_hash, name);
+
+    return data && !data->destroyed ? data->widget : NULL;
+}
+
+/* the signal_widget of the first of extra_widgets */
+#define EXTRA_WIDGETS_START(priv) \
+    ((priv)->index ? (priv)->index->n_widgets : 0)
+
+/* the location of the widget in slot @slot of widgets and
+ * extra_widgets (see GladeWidgetData), or NULL */
+static GtkWidget **
+glade_xml_widget_slot(GladeXMLPrivate *priv, guint slot)
+{
+    if (slot == 0)
+	return NULL;
+    if (slot <= priv->n_widgets)
+	return &priv->widgets[slot - 1];
+    return (GtkWidget **)&g_ptr_array_index(priv->extra_widgets,
+					    slot - 1 - priv->n_widgets);
+}
+
+/* the object a signal should be connected on, or NULL if that widget
+ * hasn't been built or has been destroyed */
+static GObject *
+glade_xml_signal_object(GladeXML *self, const GladeSignalData *data)
+{
+    GladeXMLPrivate *priv = self->priv;
+    guint extra_start = EXTRA_WIDGETS_START(priv);
+
+    if (data->signal_widget < extra_start) {
+	/* unsigned, so this also catches widgets before the root */
+	if (data->signal_widget - priv->first_widget < priv->n_widgets)
+	    return (GObject *)priv->widgets[data->signal_widget -
+					    priv->first_widget];
+	return NULL;
+    }
+    return g_ptr_array_index(priv->extra_widgets,
+			     data->signal_widget - extra_start);
+}
+
+typedef void (* GladeHandlerFunc) (GladeXML *self, const char *handler_name,
+				   const GladeSignalData *signals,
+				   guint n_signals, gpointer user_data);
+
+typedef struct {
+    GladeXML *self;
+    GladeHandlerFunc func;
+    gpointer user_data;
+} handler_foreach_data;
+
+static void
+extra_handler_foreach(const char *handler_name, GArray *signals,
+		      handler_foreach_data *data)
+{
+    (* data->func) (data->self, handler_name,
+		    (GladeSignalData *)signals->data, signals->len,
+		    data->user_data);
+}
+
+/* call @func with the signals of the handler @handler_name, or of
+ * every handler if it is NULL.  A handler may be seen twice, if
+ * widgets from outside the index use it as well. */
+static void
+glade_xml_handler_foreach(GladeXML *self, const char *handler_name,
+			  GladeHandlerFunc func, gpointer user_data)
+{
+    GladeXMLPrivate *priv = self->priv;
+    guint i;
+
+    if (handler_name) {
+	GladeHandlerSignals *handler = NULL;
+	GArray *extra = NULL;
+
+	if (priv->index)
+	    handler = g_hash_table_lookup(priv->index->handler_hash,
+					  handler_name);
+	if (handler)
+	    (* func) (self, handler->handler_name, handler->signals,
+		      handler->n_signals, user_data);
+	if (priv->extra_signals)
+	    extra = g_hash_table_lookup(priv->extra_signals, handler_name);
+	if (extra)
+	    (* func) (self, handler_name, (GladeSignalData *)extra->data,
+		      extra->len, user_data);
+	return;
+    }
+
+    if (priv->index)
+	for (i = 0; i < priv->index->n_handlers; i++) {
+	    GladeHandlerSignals *handler = &priv->index->handlers[i];
+
+	    (* func) (self, handler->handler_name, handler->signals,
+		      handler->n_signals, user_data);
+	}
+    if (priv->extra_signals) {
+	handler_foreach_data data;
+
+	data.self = self;
+	data.func = func;
+	data.user_data = user_data;
+	g_hash_table_foreach(priv->extra_signals,
+			     (GHFunc)extra_handler_foreach, &data);
+    }
+}
+
+typedef struct {
+    guint signal_id;
+    gboolean swapped;
+    GObject *swap_object;
+    GClosure *closure;
+} SharedClosure;
+
+/* connect @func to the signals of one handler through as few closures
+ * as possible (GLADE_BUILD_SHARE_CLOSURES).  A closure can only be
+ * shared between connections to the same signal, since it takes on
+ * that signal's marshaller, and between connections passing the same
+ * data to the handler. */
+static void
+connect_handler_signals_shared(GladeXML *self, const GladeSignalData *signals,
+			       guint n_signals, GCallback func,
+			       gpointer user_data)
+{
+    GArray *closures;
+    guint i, j;
+
+    closures = g_array_new(FALSE, FALSE, sizeof(SharedClosure));
+    for (i = 0; i < n_signals; i++) {
+	const GladeSignalData *data = &signals[i];
+	GObject *object = glade_xml_signal_object(self, data);
+	GObject *other = NULL;
+	SharedClosure *shared = NULL;
+	guint signal_id;
+	GQuark detail;
+
+	if (!object)
+	    continue;
+	if (!g_signal_parse_name(data->signal_name, G_OBJECT_TYPE(object),
+				 &signal_id, &detail, TRUE)) {
+	    g_warning("%s: signal `%s' is invalid for instance `%p'",
+		      G_STRLOC, data->signal_name, object);
+	    continue;
+	}
+	if (data->connect_object)
+	    other = (GObject *)glade_xml_lookup(self, data->connect_object);
+
+	for (j = 0; j < closures->len; j++) {
+	    shared = &g_array_index(closures, SharedClosure, j);
+	    if (shared->signal_id == signal_id &&
+		shared->swapped == (data->connect_object != NULL) &&
+		shared->swap_object == other)
+		break;
+	    shared = NULL;
+	}
+	if (!shared) {
+	    SharedClosure new_shared;
+
+	    new_shared.signal_id = signal_id;
+	    new_shared.swapped = data->connect_object != NULL;
+	    new_shared.swap_object = other;
+	    if (data->connect_object) {
+		new_shared.closure = g_cclosure_new_swap(func, other, NULL);
+		if (other)
+		    g_object_watch_closure(other, new_shared.closure);
+	    } else
+		new_shared.closure = g_cclosure_new(func, user_data, NULL);
+	    g_array_append_val(closures, new_shared);
+	    shared = &g_array_index(closures, SharedClosure, closures->len - 1);
+	}
+
+	/* the first connection sinks the closure, and each later one
+	 * adds a reference */
+	g_signal_connect_closure_by_id(object, signal_id, detail,
+				       shared->closure, data->signal_after);
+    }
+    g_array_free(closures, TRUE);
+}
+
+/* signal handler timing (GLADE_BUILD_TIME_HANDLERS, or "handlers" in
+ * LIBGLADE_DEBUG).  Handlers connected while it is on get marshal
+ * guards that time each call.  The statistics are kept per handler
+ * and widget for the rest of the process, as the closures refer to
+ * them. */
+
+typedef struct {
+    gchar *handler_name;
+    gchar *widget_name;
+    guint n_calls;
+    gdouble total_time;
+    gdouble max_time;
+    GArray *starts; /* start times of the calls in progress */
+} HandlerStats;
+
+static GHashTable *handler_stats = NULL;
+
+/* seconds from some fixed point in time */
+gdouble
+_glade_get_time(void)
+{
+#if GLIB_CHECK_VERSION(2, 28, 0)
+    return g_get_monotonic_time() / (gdouble)G_USEC_PER_SEC;
+#else
+    GTimeVal now;
+
+    g_get_current_time(&now);
+    return now.tv_sec + now.tv_usec / (gdouble)G_USEC_PER_SEC;
+#endif
+}
+
+static gboolean
+handler_timing_enabled(GladeXML *self)
+{
+    return (self->priv->build_flags & GLADE_BUILD_TIME_HANDLERS) ||
+	(_glade_debug_flags & GLADE_DEBUG_HANDLERS);
+}
+
+static void
+handler_timing_start(gpointer data, GClosure *closure)
+{
+    HandlerStats *stats = data;
+    gdouble now = _glade_get_time();
+
+    g_array_append_val(stats->starts, now);
+}
+
+static void
+handler_timing_end(gpointer data, GClosure *closure)
+{
+    HandlerStats *stats = data;
+    gdouble elapsed;
+
+    elapsed = _glade_get_time() -
+	g_array_index(stats->starts, gdouble, stats->starts->len - 1);
+    g_array_set_size(stats->starts, stats->starts->len - 1);
+
+    stats->n_calls++;
+    stats->total_time += elapsed;
+    if (elapsed > stats->max_time)
+	stats->max_time = elapsed;
+}
+
+/* add timing guards to a closure about to be connected to @object.
+ * A closure can only have one pair, so this is only used on closures
+ * libglade made itself. */
+static void
+glade_time_closure(GClosure *closure, const gchar *handler_name,
+		   GObject *object)
+{
+    const gchar *widget_name = NULL;
+    HandlerStats *stats;
+    gchar *key;
+
+    if (GTK_IS_WIDGET(object))
+	widget_name = glade_get_widget_name(GTK_WIDGET(object));
+    if (!widget_name)
+	widget_name = G_OBJECT_TYPE_NAME(object);
+
+    if (!handler_stats)
+	handler_stats = g_hash_table_new(g_str_hash, g_str_equal);
+    key = g_strconcat(handler_name, "\n", widget_name, NULL);
+    stats = g_hash_table_lookup(handler_stats, key);
+    if (!stats) {
+	stats = g_new0(HandlerStats, 1);
+	stats->handler_name = g_strdup(handler_name);
+	stats->widget_name = g_strdup(widget_name);
+	stats->starts = g_array_new(FALSE, FALSE, sizeof(gdouble));
+	g_hash_table_insert(handler_stats, key, stats);
+    } else
+	g_free(key);
+
+    g_closure_add_marshal_guards(closure, stats, handler_timing_start,
+				 stats, handler_timing_end);
+}
+
+/* a closure timing another one.  Closures passed to
+ * glade_xml_signal_connect_closures() may already have marshal guards,
+ * or be connected more than once, so they are wrapped rather than
+ * guarded themselves. */
+typedef struct {
+    GClosure closure;
+    GClosure *inner;
+    guint watching : 1; /* the invalidate notifier is still on inner */
+} TimedClosure;
+
+/* the wrapper's meta marshal.  The signal sets the wrapper's marshal,
+ * which is passed on to an inner closure that has none. */
+static void
+timed_closure_marshal(GClosure *closure, GValue *return_value,
+		      guint n_param_values, const GValue *param_values,
+		      gpointer invocation_hint, gpointer marshal_data)
+{
+    GClosure *inner = ((TimedClosure *)closure)->inner;
+
+    if (G_CLOSURE_NEEDS_MARSHAL(inner) && closure->marshal)
+	g_closure_set_marshal(inner, closure->marshal);
+    g_closure_invoke(inner, return_value, n_param_values, param_values,
+		     invocation_hint);
+}
+
+static void
+timed_closure_inner_invalidated(gpointer data, GClosure *inner)
+{
+    ((TimedClosure *)data)->watching = FALSE;
+    g_closure_invalidate(data);
+}
+
+static void
+timed_closure_finalize(gpointer data, GClosure *closure)
+{
+    TimedClosure *timed = (TimedClosure *)closure;
+
+    if (timed->watching)
+	g_closure_remove_invalidate_notifier(timed->inner, timed,
+					     timed_closure_inner_invalidated);
+    g_closure_unref(timed->inner);
+}
+
+/* a closure calling @inner, with timing guards for @handler_name on
+ * @object.  @inner is sunk if it is floating. */
+static GClosure *
+glade_timed_closure_new(GClosure *inner, const gchar *handler_name,
+			GObject *object)
+{
+    GClosure *closure = g_closure_new_simple(sizeof(TimedClosure), NULL);
+    TimedClosure *timed = (TimedClosure *)closure;
+
+    timed->inner = g_closure_ref(inner);
+    g_closure_sink(inner);
+    timed->watching = TRUE;
+    g_closure_add_invalidate_notifier(inner, timed,
+				      timed_closure_inner_invalidated);
+    g_closure_add_finalize_notifier(closure, NULL, timed_closure_finalize);
+    g_closure_set_meta_marshal(closure, NULL, timed_closure_marshal);
+    glade_time_closure(closure, handler_name, object);
+    return closure;
+}
+
+static void
+connect_handler_signals_timed(GladeXML *self, const char *handler_name,
+			      const GladeSignalData *signals, guint n_signals,
+			      GCallback func, gpointer user_data)
+{
+    guint i;
+
+    for (i = 0; i < n_signals; i++) {
+	const GladeSignalData *data = &signals[i];
+	GObject *object = glade_xml_signal_object(self, data);
+	GClosure *closure;
+
+	if (!object)
+	    continue;
+	if (data->connect_object) {
+	    GObject *other = (GObject *)glade_xml_lookup(self,
+							 data->connect_object);
+
+	    closure = g_cclosure_new_swap(func, other, NULL);
+	    if (other)
+		g_object_watch_closure(other, closure);
+	} else
+	    closure = g_cclosure_new(func, user_data, NULL);
+
+	glade_time_closure(closure, handler_name, object);
+	g_signal_connect_closure(object, data->signal_name, closure,
+				 data->signal_after);
+    }
+}
+
+static gint
+handler_stats_compare(gconstpointer a, gconstpointer b)
+{
+    const HandlerStats *stats_a = a, *stats_b = b;
+
+    if (stats_a->total_time > stats_b->total_time)
+	return -1;
+    return stats_a->total_time < stats_b->total_time;
+}
+
+static void
+prepend_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    GList **list = user_data;
+
+    *list = g_list_prepend(*list, value);
+}
+
+/**
+ * glade_print_handler_stats:
+ *
+ * Prints how often each timed signal handler was called, and how long
+ * those calls took, slowest total first.  Handlers are timed if they
+ * were connected by libglade while %GLADE_BUILD_TIME_HANDLERS was set,
+ * or while the LIBGLADE_DEBUG environment variable contained
+ * "handlers".
+ */
+void
+glade_print_handler_stats(void)
+{
+    GList *list = NULL, *tmp;
+
+    if (handler_stats)
+	g_hash_table_foreach(handler_stats, prepend_stats, &list);
+    list = g_list_sort(list, handler_stats_compare);
+
+    g_print("%-32s %-24s %8s %12s %12s\n", "handler", "widget",
+	    "calls", "total (ms)", "max (ms)");
+    for (tmp = list; tmp; tmp = tmp->next) {
+	HandlerStats *stats = tmp->data;
+
+	g_print("%-32s %-24s %8u %12.3f %12.3f\n",
+		stats->handler_name, stats->widget_name, stats->n_calls,
+		stats->total_time * 1000, stats->max_time * 1000);
+    }
+    g_list_free(list);
+}
+
+static void
+reset_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    HandlerStats *stats = value;
+
+    stats->n_calls = 0;
+    stats->total_time = 0;
+    stats->max_time = 0;
+}
+
+/**
+ * glade_reset_handler_stats:
+ *
+ * Sets the counters printed by glade_print_handler_stats() back to
+ * zero.
+ */
+void
+glade_reset_handler_stats(void)
+{
+    if (handler_stats)
+	g_hash_table_foreach(handler_stats, reset_stats, NULL);
+}
+
+/* connect @func to the signals of one handler, the way
+ * glade_xml_signal_connect_data() does */
+static void
+connect_handler_signals(GladeXML *self, const char *handler_name,
+			const GladeSignalData *signals, guint n_signals,
+			GCallback func, gpointer user_data)
+{
+    guint i;
+    gdouble start;
+
+    GLADE_PROFILE_START(start);
+    if (handler_timing_enabled(self))
+	connect_handler_signals_timed(self, handler_name, signals, n_signals,
+				      func, user_data);
+    else if (self->priv->build_flags & GLADE_BUILD_SHARE_CLOSURES)
+	connect_handler_signals_shared(self, signals, n_signals,
+				       func, user_data);
+    else
+	for (i = 0; i < n_signals; i++) {
+	    const GladeSignalData *data = &signals[i];
+	    GObject *object = glade_xml_signal_object(self, data);
+
+	    if (!object)
+		continue;
+	    if (data->connect_object) {
+		GObject *other = (GObject *)glade_xml_lookup(self,
+							     data->connect_object);
+
+		g_signal_connect_object(object, data->signal_name,
+			func, other, (data->signal_after ? G_CONNECT_AFTER : 0)
+					| G_CONNECT_SWAPPED);
+	    } else {
+		/* the signal_data argument is just a string, but may be
+		 * helpful for someone */
+		g_signal_connect_data(object, data->signal_name, func,
+				      user_data, NULL,
+				      data->signal_after ? G_CONNECT_AFTER : 0);
+	    }
+	}
+    GLADE_PROFILE_END(start, SIGNALS, NULL);
+}
+
+/* does the handler have any signals on widgets that are still
+ * around? */
+static gboolean
+handler_has_objects(GladeXML *self, const GladeSignalData *signals,
+		    guint n_signals)
+{
+    guint i;
+
+    for (i = 0; i < n_signals; i++)
+	if (glade_xml_signal_object(self, &signals[i]))
+	    return TRUE;
+    return FALSE;
+}
+
+typedef struct {
+    GCallback func;
+    gpointer user_data;
+} connect_handler_data;
+
+static void
+connect_handler_foreach(GladeXML *self, const char *handler_name,
+			const GladeSignalData *signals, guint n_signals,
+			connect_handler_data *data)
+{
+    connect_handler_signals(self, handler_name, signals, n_signals,
+			    data->func, data->user_data);
+}
+
 /**
  * glade_xml_signal_connect:
  * @self: the GladeXML object
@@ -240,67 +905,36 @@ void
 glade_xml_signal_connect (GladeXML *self, const char *handlername,
 			  GCallback func)
 {
-    GList *signals;
+    connect_handler_data data;
 
     g_return_if_fail(self != NULL);
     g_return_if_fail(handlername != NULL);
     g_return_if_fail(func != NULL);
 
-    signals = g_hash_table_lookup(self->priv->signals, handlername);
-    for (; signals != NULL; signals = signals->next) {
-	GladeSignalData *data = signals->data;
-
-	if (data->connect_object) {
-	    GObject *other = g_hash_table_lookup(self->priv->name_hash,
-						   data->connect_object);
-
-	    g_signal_connect_object(data->signal_object, data->signal_name,
-			func, other, (data->signal_after ? G_CONNECT_AFTER : 0)
-					| G_CONNECT_SWAPPED);
-	} else {
-	    /* the signal_data argument is just a string, but may be
-	     * helpful for someone */
-	    if (data->signal_after)
-		g_signal_connect_after(data->signal_object, data->signal_name,
-				       func, NULL);
-	    else
-		g_signal_connect(data->signal_object, data->signal_name,
-				 func, NULL);
-	}
-    }
+    data.func = func;
+    data.user_data = NULL;
+    glade_xml_handler_foreach(self, handlername,
+			      (GladeHandlerFunc)connect_handler_foreach, &data);
 }
 
 static void
-autoconnect_foreach(const char *signal_handler, GList *signals,
-		    GModule *allsymbols)
+autoconnect_foreach(GladeXML *self, const char *signal_handler,
+		    const GladeSignalData *signals, guint n_signals,
+		    gpointer user_data)
 {
     GCallback func;
 
-    if (!g_module_symbol(allsymbols, signal_handler, (gpointer)&func))
+    /* the index covers the whole interface, so skip handlers that
+     * only belong to widgets that weren't built */
+    if (!handler_has_objects(self, signals, n_signals))
+	return;
+
+    func = glade_symbol_cache_lookup(signal_handler);
+    if (!func)
 	g_warning("could not find signal handler '%s'.", signal_handler);
     else
-	for (; signals != NULL; signals = signals->next) {
-	    GladeSignalData *data = signals->data;
-	    if (data->connect_object) {
-		GladeXML *self = glade_get_widget_tree(
-					GTK_WIDGET(data->signal_object));
-		GObject *other = g_hash_table_lookup(self->priv->name_hash,
-						       data->connect_object);
-
-		g_signal_connect_object(data->signal_object, data->signal_name,
-			func, other, (data->signal_after ? G_CONNECT_AFTER : 0)
-					| G_CONNECT_SWAPPED);
-	    } else {
-		/* the signal_data argument is just a string, but may
-		 * be helpful for someone */
-		if (data->signal_after)
-		    g_signal_connect_after(data->signal_object,
-					   data->signal_name, func, NULL);
-		else
-		    g_signal_connect(data->signal_object, data->signal_name,
-				     func, NULL);
-	    }
-	}
+	connect_handler_signals(self, signal_handler, signals, n_signals,
+				func, NULL);
 }
 
 /**
@@ -323,16 +957,16 @@ autoconnect_foreach(const char *signal_handler, GList *signals,
 void
 glade_xml_signal_autoconnect (GladeXML *self)
 {
-    GModule *allsymbols;
-
     g_return_if_fail(self != NULL);
     if (!g_module_supported())
 	g_error("glade_xml_signal_autoconnect requires working gmodule");
 
-    /* get a handle on the main executable -- use this to find symbols */
-    allsymbols = g_module_open(NULL, 0);
-    g_hash_table_foreach(self->priv->signals, (GHFunc)autoconnect_foreach,
-			 allsymbols);
+    /* symbols are looked up in the main executable, through the
+     * symbol cache */
+    GLADE_TRACE_BEGIN("glade_xml_signal_autoconnect", "signals",
+		      "file", self->filename);
+    glade_xml_handler_foreach(self, NULL, autoconnect_foreach, NULL);
+    GLADE_TRACE_END("glade_xml_signal_autoconnect", "signals");
 }
 
 
@@ -342,23 +976,24 @@ typedef struct {
 } connect_struct;
 
 static void
-autoconnect_full_foreach(const char *signal_handler, GList *signals,
+autoconnect_full_foreach(GladeXML *self, const char *signal_handler,
+			 const GladeSignalData *signals, guint n_signals,
 			 connect_struct *conn)
 {
-    GladeXML *self = NULL;
+    guint i;
 
-    for (; signals != NULL; signals = signals->next) {
-	GladeSignalData *data = signals->data;
+    for (i = 0; i < n_signals; i++) {
+	const GladeSignalData *data = &signals[i];
+	GObject *object = glade_xml_signal_object(self, data);
 	GObject *connect_object = NULL;
-		
-	if (data->connect_object) {
-	    if (!self)
-		self = glade_get_widget_tree(GTK_WIDGET(data->signal_object));
-	    connect_object = g_hash_table_lookup(self->priv->name_hash,
-						 data->connect_object);
-	}
 
-	(* conn->func) (signal_handler, data->signal_object,
+	if (!object)
+	    continue;
+	if (data->connect_object)
+	    connect_object = (GObject *)glade_xml_lookup(self,
+							 data->connect_object);
+
+	(* conn->func) (signal_handler, object,
 			data->signal_name, NULL,
 			connect_object, data->signal_after,
 			conn->user_data);
@@ -400,7 +1035,6 @@ glade_xml_signal_connect_full(GladeXML *self, const gchar *handler_name,
 			      GladeXMLConnectFunc func, gpointer user_data)
 {
     connect_struct conn;
-    GList *signals;
 
     g_return_if_fail(self != NULL);
     g_return_if_fail(handler_name != NULL);
@@ -410,8 +1044,9 @@ glade_xml_signal_connect_full(GladeXML *self, const gchar *handler_name,
      * version, just reuse its helper function */
     conn.func = func;
     conn.user_data = user_data;
-    signals = g_hash_table_lookup(self->priv->signals, handler_name);
-    autoconnect_full_foreach(handler_name, signals, &conn);
+    glade_xml_handler_foreach(self, handler_name,
+			      (GladeHandlerFunc)autoconnect_full_foreach,
+			      &conn);
 }
 
 /**
@@ -437,8 +1072,129 @@ glade_xml_signal_autoconnect_full (GladeXML *self, GladeXMLConnectFunc func,
 
     conn.func = func;
     conn.user_data = user_data;
-    g_hash_table_foreach(self->priv->signals,
-			 (GHFunc)autoconnect_full_foreach, &conn);
+    GLADE_TRACE_BEGIN("glade_xml_signal_autoconnect_full", "signals",
+		      "file", self->filename);
+    glade_xml_handler_foreach(self, NULL,
+			      (GladeHandlerFunc)autoconnect_full_foreach,
+			      &conn);
+    GLADE_TRACE_END("glade_xml_signal_autoconnect_full", "signals");
+}
+
+/**
+ * GladeSignalRecord:
+ * @handler_name: the name of the signal handler.
+ * @object: the object the signal is emitted on.
+ * @signal_name: the name of the signal.
+ * @connect_object: the object to pass to the handler instead of
+ * @object (the g_signal_connect_object() behaviour), or %NULL.
+ * @after: %TRUE if the handler should run after the default handler.
+ *
+ * A description of one signal connection from an interface, as
+ * returned by glade_xml_get_signal_records().
+ */
+
+static void
+collect_records_foreach(GladeXML *self, const char *signal_handler,
+			const GladeSignalData *signals, guint n_signals,
+			GArray *records)
+{
+    guint i;
+
+    for (i = 0; i < n_signals; i++) {
+	const GladeSignalData *data = &signals[i];
+	GladeSignalRecord record;
+
+	record.object = glade_xml_signal_object(self, data);
+	if (!record.object)
+	    continue;
+	record.handler_name = signal_handler;
+	record.signal_name = data->signal_name;
+	record.connect_object = NULL;
+	if (data->connect_object)
+	    record.connect_object =
+		(GObject *)glade_xml_lookup(self, data->connect_object);
+	record.after = data->signal_after;
+	g_array_append_val(records, record);
+    }
+}
+
+/**
+ * glade_xml_get_signal_records:
+ * @self: the GladeXML object.
+ * @n_records: return location for the number of records.
+ *
+ * Describes every signal connection in the interface in a single
+ * array.  This lets a language binding resolve all the handlers in
+ * one go and then connect them with glade_xml_signal_connect_closures(),
+ * rather than being called back once per signal as with
+ * glade_xml_signal_autoconnect_full().
+ *
+ * The strings in the records belong to @self.
+ *
+ * Returns: a newly allocated array of @n_records records, to be freed
+ * with g_free().
+ */
+GladeSignalRecord *
+glade_xml_get_signal_records(GladeXML *self, guint *n_records)
+{
+    GArray *records;
+
+    g_return_val_if_fail(GLADE_IS_XML(self), NULL);
+    g_return_val_if_fail(n_records != NULL, NULL);
+
+    records = g_array_new(FALSE, FALSE, sizeof(GladeSignalRecord));
+    glade_xml_handler_foreach(self, NULL,
+			      (GladeHandlerFunc)collect_records_foreach,
+			      records);
+
+    *n_records = records->len;
+    return (GladeSignalRecord *)g_array_free(records, FALSE);
+}
+
+/**
+ * glade_xml_signal_connect_closures:
+ * @self: the GladeXML object.
+ * @records: signal records from glade_xml_get_signal_records().
+ * @closures: an array holding a closure for each record, or %NULL
+ * for records that should not be connected.
+ * @n_records: the number of records.
+ *
+ * Connects each closure to the signal described by the matching
+ * record.  Floating closures are sunk.  If a record has a
+ * connect_object, the closure is invalidated when that object is
+ * finalised, but passing it to the handler is left to the closure.
+ */
+void
+glade_xml_signal_connect_closures(GladeXML *self,
+				  const GladeSignalRecord *records,
+				  GClosure **closures, guint n_records)
+{
+    guint i;
+    gdouble start;
+
+    g_return_if_fail(GLADE_IS_XML(self));
+    g_return_if_fail(records != NULL || n_records == 0);
+    g_return_if_fail(closures != NULL || n_records == 0);
+
+    GLADE_PROFILE_START(start);
+    for (i = 0; i < n_records; i++) {
+	if (!closures[i])
+	    continue;
+	if (records[i].connect_object)
+	    g_object_watch_closure(records[i].connect_object, closures[i]);
+	if (handler_timing_enabled(self))
+	    g_signal_connect_closure(records[i].object,
+				     records[i].signal_name,
+				     glade_timed_closure_new(closures[i],
+							     records[i].handler_name,
+							     records[i].object),
+				     records[i].after);
+	else
+	    g_signal_connect_closure(records[i].object,
+				     records[i].signal_name,
+				     closures[i], records[i].after);
+    }
+    GLADE_PROFILE_END(start, SIGNALS, NULL);
 }
 
 /**
@@ -453,46 +1209,110 @@ glade_xml_signal_autoconnect_full (GladeXML *self, GladeXMLConnectFunc func,
  * all signals in the GladeXML file with the given signal handler name.
  *
  * It differs from glade_xml_signal_connect since it allows you to
- * specify the data parameter for the signal handler.  It is also a small
- * demonstration of how to use glade_xml_signal_connect_full.
+ * specify the data parameter for the signal handler.
  */
+void
+glade_xml_signal_connect_data (GladeXML *self, const char *handlername,
+			       GCallback func, gpointer user_data)
+{
+    connect_handler_data data;
+
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(handlername != NULL);
+    g_return_if_fail(func != NULL);
+
+    data.func = func;
+    data.user_data = user_data;
+    glade_xml_handler_foreach(self, handlername,
+			      (GladeHandlerFunc)connect_handler_foreach, &data);
+}
+
+/**
+ * GladeHandlerEntry:
+ * @name: the signal handler name used in the interface description.
+ * @callback: the function to connect for that name.
+ *
+ * An entry in a table of signal handlers passed to
+ * glade_xml_signal_connect_table().
+ */
+
+static int
+handler_entry_compare(const void *a, const void *b)
+{
+    const GladeHandlerEntry *entry_a = *(const GladeHandlerEntry **)a;
+    const GladeHandlerEntry *entry_b = *(const GladeHandlerEntry **)b;
+
+    return strcmp(entry_a->name, entry_b->name);
+}
+
+static int
+handler_name_compare(const void *key, const void *member)
+{
+    const GladeHandlerEntry *entry = *(const GladeHandlerEntry **)member;
+
+    return strcmp(key, entry->name);
+}
+
 typedef struct {
-    GCallback func;
+    const GladeHandlerEntry **sorted; /* the table, sorted by name */
+    guint n_entries;
     gpointer user_data;
-} connect_data_data;
+} connect_table_data;
 
 static void
-connect_data_connect_func(const gchar *handler_name, GObject *object,
-			  const gchar *signal_name, const gchar *signal_data,
-			  GObject *connect_object, gboolean after,
-			  gpointer user_data)
+connect_table_foreach(GladeXML *self, const char *signal_handler,
+		      const GladeSignalData *signals, guint n_signals,
+		      connect_table_data *conn)
 {
-    connect_data_data *data = (connect_data_data *)user_data;
-
-    if (connect_object) {
-	g_signal_connect_object(object, signal_name, data->func,
-	    connect_object, (after ? G_CONNECT_AFTER : 0) | G_CONNECT_SWAPPED);
-    } else {
-	if (after)
-	    g_signal_connect_after(object, signal_name,
-				   data->func, data->user_data);
-	else
-	    g_signal_connect(object, signal_name,
-			     data->func, data->user_data);
-    }
+    const GladeHandlerEntry **found;
+
+    found = bsearch(signal_handler, conn->sorted, conn->n_entries,
+		    sizeof(GladeHandlerEntry *),
+		    handler_name_compare);
+    if (found)
+	connect_handler_signals(self, signal_handler, signals, n_signals,
+				(*found)->callback, conn->user_data);
 }
 
+/**
+ * glade_xml_signal_connect_table:
+ * @self: the GladeXML object.
+ * @table: an array of handler names and functions.
+ * @n_entries: the number of entries in @table.
+ * @user_data: the signal handler data.
+ *
+ * Connects every signal in the interface whose handler name appears
+ * in @table, as if glade_xml_signal_connect_data() had been called for
+ * each entry.  The signals are only looked at once, however many
+ * entries there are, and no symbol lookups are needed.
+ *
+ * The handler names in @table should be unique.
+ */
 void
-glade_xml_signal_connect_data (GladeXML *self, const char *handlername,
-			       GCallback func, gpointer user_data)
+glade_xml_signal_connect_table(GladeXML *self, const GladeHandlerEntry *table,
+			       guint n_entries, gpointer user_data)
 {
-    connect_data_data data;
+    connect_table_data conn;
+    guint i;
 
-    data.func = func;
-    data.user_data = user_data;
+    g_return_if_fail(GLADE_IS_XML(self));
+    g_return_if_fail(table != NULL || n_entries == 0);
 
-    glade_xml_signal_connect_full(self, handlername,
-				  connect_data_connect_func, &data);
+    if (n_entries == 0)
+	return;
+
+    /* sort the table, so each handler in the interface is found in it
+     * by a binary search */
+    conn.sorted = g_new(const GladeHandlerEntry *, n_entries);
+    for (i = 0; i < n_entries; i++)
+	conn.sorted[i] = &table[i];
+    qsort(conn.sorted, n_entries, sizeof(GladeHandlerEntry *),
+	  handler_entry_compare);
+    conn.n_entries = n_entries;
+    conn.user_data = user_data;
+    glade_xml_handler_foreach(self, NULL,
+			      (GladeHandlerFunc)connect_table_foreach, &conn);
+    g_free(conn.sorted);
 }
 
 /**
@@ -512,7 +1332,7 @@ glade_xml_get_widget (GladeXML *self, const char *name)
     g_return_val_if_fail(self != NULL, NULL);
     g_return_val_if_fail(name != NULL, NULL);
 
-    return g_hash_table_lookup(self->priv->name_hash, name);
+    return glade_xml_lookup(self, name);
 }
 
 
@@ -535,11 +1355,11 @@ typedef struct {
 } widget_prefix_data;
 
 static void
-widget_prefix_add_to_list (gchar *name, gpointer value,
+widget_prefix_add_to_list (gchar *name, GladeWidgetData *value,
 			   widget_prefix_data *data)
 {
-    if (!strncmp (data->name, name, strlen (data->name)))
-	data->list = g_list_prepend (data->list, value);
+    if (!value->destroyed && !strncmp (data->name, name, strlen (data->name)))
+	data->list = g_list_prepend (data->list, value->widget);
 }
 
 GList *
@@ -595,10 +1415,12 @@ glade_xml_relative_file(GladeXML *self, const gchar *filename)
 const char *
 glade_get_widget_name(GtkWidget *widget)
 {
+    GladeWidgetData *data;
+
     g_return_val_if_fail(widget != NULL, NULL);
 
-    return (const char *)g_object_get_qdata(G_OBJECT(widget),
-					    glade_xml_name_id);
+    data = g_object_get_qdata(G_OBJECT(widget), glade_xml_data_id);
+    return data ? data->name : NULL;
 }
 
 /**
@@ -613,9 +1435,97 @@ glade_get_widget_name(GtkWidget *widget)
 GladeXML *
 glade_get_widget_tree(GtkWidget *widget)
 {
+    GladeWidgetData *data;
+
     g_return_val_if_fail(widget != NULL, NULL);
 
-    return g_object_get_qdata(G_OBJECT(widget), glade_xml_tree_id);
+    data = g_object_get_qdata(G_OBJECT(widget), glade_xml_data_id);
+    return data ? data->xml : NULL;
+}
+
+static void
+extra_signals_memory_stats(gpointer key, gpointer value, gpointer user_data)
+{
+    GArray *signals = value;
+
+    _glade_memory_stats_add(user_data, GLADE_MEMORY_SIGNALS, signals->len,
+			    signals->len * sizeof(GladeSignalData));
+}
+
+/**
+ * glade_xml_get_memory_stats:
+ * @self: the GladeXML object.
+ * @stats: the structure to fill in.
+ *
+ * Reports how much memory @self holds, including the interface
+ * description it was built from (see
+ * glade_interface_get_memory_stats()), but not the widgets.  An
+ * interface shared with other GladeXML objects (see
+ * glade_xml_new_from_interface()) is counted in full by each.
+ */
+void
+glade_xml_get_memory_stats(GladeXML *self, GladeMemoryStats *stats)
+{
+    GladeXMLPrivate *priv;
+    GladeWidgetData *data;
+    GList *tmp;
+
+    g_return_if_fail(GLADE_IS_XML(self));
+    g_return_if_fail(stats != NULL);
+
+    priv = self->priv;
+    memset(stats, 0, sizeof(GladeMemoryStats));
+    if (priv->tree)
+	_glade_interface_add_memory_stats(priv->tree, stats);
+    else if (priv->strings) {
+	_glade_memory_stats_add(stats, GLADE_MEMORY_STRINGS, 0,
+				priv->strings_size);
+	if (priv->index) {
+	    GladeInterfaceIndex *index = priv->index;
+
+	    _glade_memory_stats_add(stats, GLADE_MEMORY_SIGNALS,
+				    index->n_signals,
+				    sizeof(GladeInterfaceIndex) +
+				    index->n_signals * sizeof(GladeSignalData) +
+				    index->n_handlers * sizeof(GladeHandlerSignals));
+	    _glade_memory_stats_add(stats, GLADE_MEMORY_HASH_TABLES,
+				    g_hash_table_size(index->handler_hash),
+				    _glade_hash_table_memory_size(index->handler_hash));
+	}
+    }
+
+    _glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+			    sizeof(GladeXML) + sizeof(GladeXMLPrivate) +
+			    priv->n_widgets * sizeof(GtkWidget *));
+    if (self->filename)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_STRINGS, 1,
+				strlen(self->filename) + 1);
+
+    _glade_memory_stats_add(stats, GLADE_MEMORY_HASH_TABLES,
+			    g_hash_table_size(priv->name_hash),
+			    _glade_hash_table_memory_size(priv->name_hash));
+    for (data = priv->widget_data; data; data = data->next)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+				sizeof(GladeWidgetData));
+    for (data = priv->dead_widget_data; data; data = data->next)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+				sizeof(GladeWidgetData));
+    if (priv->extra_widgets)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+				priv->extra_widgets->len * sizeof(gpointer));
+    if (priv->extra_signals) {
+	_glade_memory_stats_add(stats, GLADE_MEMORY_HASH_TABLES,
+				g_hash_table_size(priv->extra_signals),
+				_glade_hash_table_memory_size(priv->extra_signals));
+	g_hash_table_foreach(priv->extra_signals,
+			     extra_signals_memory_stats, stats);
+    }
+
+    for (tmp = priv->deferred_props; tmp; tmp = tmp->next)
+	_glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+				sizeof(GList) + sizeof(GladeDeferredProperty));
+    _glade_memory_stats_add(stats, GLADE_MEMORY_OTHER, 0,
+			    sizeof(GList) * g_list_length(priv->pending_atk));
 }
 
 /* ------------------------------------------- */
@@ -679,7 +1589,7 @@ glade_xml_handle_widget_prop(GladeXML *self, GtkWidget *widget,
 
     g_return_if_fail(GLADE_IS_XML(self));
 
-    value_widget = g_hash_table_lookup(self->priv->name_hash, value_name);
+    value_widget = glade_xml_lookup(self, value_name);
     if (value_widget) {
 	g_object_set(G_OBJECT(widget), prop_name, value_widget, NULL);
     } else {
@@ -718,24 +1628,60 @@ glade_xml_ensure_accel(GladeXML *xml)
 
 /* this is a private function */
 static void
+free_signal_array(gpointer data)
+{
+    g_array_free(data, TRUE);
+}
+
+/* record the widget built for @info, which makes its signals
+ * available for connection.  Returns the slot it was put in (see
+ * GladeWidgetData). */
+static guint
 glade_xml_add_signals(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
 {
+    GladeXMLPrivate *priv = xml->priv;
+    guint position;
     gint i;
 
+    if (priv->index && GLADE_INDEX_HAS_WIDGET(priv->index, info)) {
+	position = GLADE_INDEX_WIDGET_POSITION(priv->index, info) -
+	    priv->first_widget;
+	if (position < priv->n_widgets) {
+	    priv->widgets[position] = w;
+	    return position + 1;
+	}
+    }
+
+    /* the info isn't part of the interface, or not under the root, so
+     * keep its signals here */
+    if (info->n_signals == 0)
+	return 0;
+    if (!priv->extra_widgets) {
+	priv->extra_widgets = g_ptr_array_new();
+	priv->extra_signals = g_hash_table_new_full(g_str_hash, g_str_equal,
+						    NULL, free_signal_array);
+    }
+    g_ptr_array_add(priv->extra_widgets, w);
+    position = priv->extra_widgets->len - 1;
+
     for (i = 0; i < info->n_signals; i++) {
 	GladeSignalInfo *sig = &info->signals[i];
-	GladeSignalData *data = g_new0(GladeSignalData, 1);
-	GList *list;
-
-	data->signal_object = G_OBJECT(w);
-	data->signal_name = sig->name;
-	data->connect_object = sig->object;
-	data->signal_after = sig->after;
-
-	list = g_hash_table_lookup(xml->priv->signals, sig->handler);
-	list = g_list_prepend(list, data);
-	g_hash_table_insert(xml->priv->signals, sig->handler, list);
+	GladeSignalData data;
+	GArray *signals;
+
+	data.signal_widget = EXTRA_WIDGETS_START(priv) + position;
+	data.signal_name = sig->name;
+	data.connect_object = sig->object;
+	data.signal_after = sig->after;
+
+	signals = g_hash_table_lookup(priv->extra_signals, sig->handler);
+	if (!signals) {
+	    signals = g_array_new(FALSE, FALSE, sizeof(GladeSignalData));
+	    g_hash_table_insert(priv->extra_signals, sig->handler, signals);
+	}
+	g_array_append_val(signals, data);
     }
+    return priv->n_widgets + position + 1;
 }
 
 /* this is a private function */
@@ -779,9 +1725,12 @@ glade_xml_add_atk_actions(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
     }
 }
 
-/* this is a private function */
+/* this is a private function.  A relation whose target hasn't been
+ * built yet is deferred until it is, if @defer is set, and dropped
+ * otherwise. */
 static void
-glade_xml_add_atk_relations(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
+glade_xml_add_atk_relations(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info,
+			    gboolean defer)
 {
     gint i;
     AtkObject *accessible;
@@ -806,6 +1755,10 @@ glade_xml_add_atk_relations(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
 
 	    atk_relation_set_add_relation_by_type (relations, relation_type,
 						   target_accessible);
+	} else if (!defer) {
+	    g_warning("accessibility relation `%s' of `%s' refers to"
+		      " widget `%s', which doesn't exist",
+		      rinfo->type, info->name, rinfo->target);
 	} else {
 	    GladeDeferredProperty *dprop = g_new(GladeDeferredProperty, 1);
 
@@ -839,10 +1792,15 @@ glade_xml_add_accels(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
 }
 
 static void
-glade_xml_add_accessibility_info(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
+glade_xml_apply_atk_info(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info,
+			 gboolean defer)
 {
     gint i;
-    AtkObject *accessible = gtk_widget_get_accessible (w);
+    AtkObject *accessible;
+    gdouble start;
+
+    GLADE_PROFILE_START(start);
+    accessible = gtk_widget_get_accessible (w);
     
     for (i = 0; i < info->n_atk_props; i++) {
 	GParamSpec *pspec;
@@ -869,36 +1827,78 @@ glade_xml_add_accessibility_info(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *i
 
     /* Hang on, we're not done yet ;-) */
     glade_xml_add_atk_actions(xml, w, info);
-    glade_xml_add_atk_relations(xml, w, info);
-    /*
-       hmm, might have to defer some relations,
-       if the widgets they refer to haven't
-       been constructed yet (will look at the other prop-as-widget
-       stuff for ideas)
-    */
+    glade_xml_add_atk_relations(xml, w, info, defer);
+    GLADE_PROFILE_END(start, ATK, info->classname);
+}
+
+/* is an accessibility implementation such as gail loaded?  Without
+ * one, gtk_widget_get_accessible() only hands out no-op objects. */
+static gboolean
+glade_accessibility_enabled(void)
+{
+    AtkObjectFactory *factory;
+
+    factory = atk_registry_get_factory(atk_get_default_registry(),
+				       GTK_TYPE_WIDGET);
+    return factory != NULL && !ATK_IS_NO_OP_OBJECT_FACTORY(factory);
 }
 
 static void
-glade_xml_destroy_signals(char *key, GList *signal_datas)
+glade_xml_add_accessibility_info(GladeXML *xml, GtkWidget *w, GladeWidgetInfo *info)
 {
-    GList *tmp;
+    /* asking for the accessible creates it, so don't bother for
+     * widgets that have nothing to set on it. */
+    if (info->n_atk_props == 0 && info->n_atk_actions == 0 &&
+	info->n_relations == 0)
+	return;
 
-    for (tmp = signal_datas; tmp; tmp = tmp->next) {
-	GladeSignalData *data = tmp->data;
-	g_free(data);
+    if ((xml->priv->build_flags & GLADE_BUILD_DEFER_ATK) &&
+	!glade_accessibility_enabled()) {
+	xml->priv->pending_atk = g_list_prepend(xml->priv->pending_atk, info);
+	return;
     }
-    g_list_free(signal_datas);
+
+    glade_xml_apply_atk_info(xml, w, info, TRUE);
 }
 
-static void
-remove_data_func(gpointer key, gpointer value, gpointer user_data)
+/**
+ * glade_xml_apply_accessibility_info:
+ * @self: the GladeXML object.
+ *
+ * If the interface was built with %GLADE_BUILD_DEFER_ATK while no
+ * accessibility support was loaded, the accessibility properties,
+ * actions and relations it contains have not been applied yet.  This
+ * function applies them to those widgets that still exist.  It is
+ * meant to be called once accessibility support has been enabled.
+ */
+void
+glade_xml_apply_accessibility_info(GladeXML *self)
 {
-    GObject *object = value;
+    GList *pending, *tmp;
+
+    g_return_if_fail(GLADE_IS_XML(self));
+
+    /* the list was built up with prepends */
+    pending = g_list_reverse(self->priv->pending_atk);
+    self->priv->pending_atk = NULL;
+
+    for (tmp = pending; tmp; tmp = tmp->next) {
+	GladeWidgetInfo *info = tmp->data;
+	GtkWidget *widget;
 
-    g_object_set_qdata(object, glade_xml_tree_id, NULL);
-    g_object_set_qdata(object, glade_xml_name_id, NULL);
+	widget = glade_xml_lookup(self, info->name);
+	if (widget)
+	    /* the build is over, so missing targets won't turn up */
+	    glade_xml_apply_atk_info(self, widget, info, FALSE);
+    }
+    g_list_free(pending);
+
+    if (self->priv->compact_pending)
+	glade_xml_compact(self);
 }
 
+static void glade_xml_widget_detach(GladeWidgetData *data);
+
 static void
 glade_xml_finalize(GObject *object)
 {
@@ -909,15 +1909,28 @@ glade_xml_finalize(GObject *object)
     self->filename = NULL;
 
     if (priv) {
+	GladeWidgetData *data, *next;
+
 	/* remove data items from all the widgets that are still
          * live. */
-	g_hash_table_foreach(priv->name_hash, remove_data_func, self);
+	for (data = priv->widget_data; data; data = next) {
+	    next = data->next;
+	    glade_xml_widget_detach(data);
+	    g_free(data);
+	}
+	for (data = priv->dead_widget_data; data; data = next) {
+	    next = data->next;
+	    g_free(data);
+	}
 	/* strings are owned in the GladeInterface structure */
 	g_hash_table_destroy(priv->name_hash);
 
-	g_hash_table_foreach(priv->signals,
-			     (GHFunc)glade_xml_destroy_signals, NULL);
-	g_hash_table_destroy(priv->signals);
+	/* the index belongs to the GladeInterface */
+	g_free(priv->widgets);
+	if (priv->extra_widgets) {
+	    g_ptr_array_free(priv->extra_widgets, TRUE);
+	    g_hash_table_destroy(priv->extra_signals);
+	}
 
 	if (priv->tooltips)
 	    g_object_unref(priv->tooltips);
@@ -925,8 +1938,16 @@ glade_xml_finalize(GObject *object)
 	if (priv->accel_group)
 	    g_object_unref(priv->accel_group);
 
+	g_list_free(priv->pending_atk);
+
 	if (priv->tree)
-	    glade_interface_destroy(priv->tree);
+	    glade_interface_unref(priv->tree);
+	if (priv->strings) {
+	    /* a compacted GladeXML owns its index */
+	    if (priv->index)
+		_glade_interface_index_free(priv->index);
+	    g_string_chunk_free(priv->strings);
+	}
 
     }
     self->priv = NULL;
@@ -956,15 +1977,14 @@ default_custom_handler(GladeXML *xml, gchar *func_name, gchar *name,
     typedef GtkWidget *(* create_func)(gchar *name,
 				       gchar *string1, gchar *string2,
 				       gint int1, gint int2);
-    GModule *allsymbols;
     create_func func;
 
     if (!g_module_supported()) {
 	g_error("custom_new requires gmodule to work correctly");
 	return NULL;
     }
-    allsymbols = g_module_open(NULL, 0);
-    if (g_module_symbol(allsymbols, func_name, (gpointer)&func))
+    func = (create_func)glade_symbol_cache_lookup(func_name);
+    if (func)
 	return (* func)(name, string1, string2, int1, int2);
     g_warning("could not find widget creation function '%s'.", func_name);
     return NULL;
@@ -991,6 +2011,116 @@ glade_set_custom_handler(GladeXMLCustomWidgetHandler handler,
     custom_user_data = user_data;
 }
 
+/**
+ * GladeBuildFlags:
+ * @GLADE_BUILD_FREEZE_NOTIFY: hold back property and child property
+ * notifications on every widget until the whole interface has been
+ * built, and show toplevel windows only after that.
+ * @GLADE_BUILD_DEFER_ATK: when no accessibility support is loaded,
+ * don't create accessible objects while building.  The accessibility
+ * information from the interface is kept until
+ * glade_xml_apply_accessibility_info() is called.
+ * @GLADE_BUILD_PREFETCH_IMAGES: decode the images referenced by the
+ * interface on a pool of worker threads while the widgets are being
+ * built.  This only has an effect if the GLib thread system has been
+ * initialised, and not with %GLADE_BUILD_LAZY_IMAGES.
+ * @GLADE_BUILD_LAZY_IMAGES: give image valued properties, pixmaps and
+ * tool button icons a transparent placeholder of the right size, and
+ * only load the image when the widget is first mapped.  The image is
+ * not loaded if the property has been set to something else by then.
+ * Placeholders are shared between the images of the same size, so
+ * they must not be modified.
+ * @GLADE_BUILD_SHARE_CLOSURES: when glade_xml_signal_connect() and
+ * friends connect a handler to many signals, use one closure for all
+ * the connections to the same signal instead of one per connection.
+ * This flag is checked when signals are connected, not when the
+ * interface is built.
+ * @GLADE_BUILD_TIME_HANDLERS: time the signal handlers libglade
+ * connects (see glade_print_handler_stats()).  Like
+ * %GLADE_BUILD_SHARE_CLOSURES, this is checked when signals are
+ * connected, and it takes precedence over that flag.
+ * @GLADE_BUILD_PROFILE: keep count of the time spent in each phase of
+ * building interfaces (see glade_get_profile_stats()).
+ * @GLADE_BUILD_COMPACT: once the interface has been built, copy the
+ * widget names and signal information into a small pool owned by the
+ * GladeXML object, and release the parsed interface.  With
+ * %GLADE_BUILD_DEFER_ATK, this waits for
+ * glade_xml_apply_accessibility_info().  It is not done if some
+ * widget properties refer to widgets that were not built.
+ *
+ * Options that change the way libglade builds interfaces.  Each
+ * GladeXML object has its own (see glade_xml_set_build_flags()), which
+ * start out as the defaults set with glade_set_build_flags().  All but
+ * %GLADE_BUILD_SHARE_CLOSURES and %GLADE_BUILD_TIME_HANDLERS are read
+ * while the interface is built, and %GLADE_BUILD_PROFILE only from the
+ * defaults.
+ */
+
+/**
+ * glade_set_build_flags:
+ * @flags: the new build flags.
+ *
+ * Sets the default options of GladeXML objects created after this
+ * call.  This affects the whole program, so libraries and plugins
+ * should set the options of their own GladeXML objects with
+ * glade_xml_set_build_flags() instead.  %GLADE_BUILD_PROFILE is the
+ * exception: profiling is only turned on and off here, for the whole
+ * program.
+ */
+void
+glade_set_build_flags(GladeBuildFlags flags)
+{
+    build_flags = flags;
+    _glade_profile_enabled = (flags & GLADE_BUILD_PROFILE) ||
+	(_glade_debug_flags & GLADE_DEBUG_PROFILE);
+}
+
+/**
+ * glade_get_build_flags:
+ *
+ * Returns: the options used when building interfaces.
+ */
+GladeBuildFlags
+glade_get_build_flags(void)
+{
+    return build_flags;
+}
+
+/**
+ * glade_xml_set_build_flags:
+ * @self: the GladeXML object.
+ * @flags: the new build flags.
+ *
+ * Sets the options of @self alone, which start out as those from
+ * glade_get_build_flags() when it was created.  The options that
+ * change the way the interface is built have to be set between
+ * g_object_new() and glade_xml_construct() to have an effect, while
+ * %GLADE_BUILD_SHARE_CLOSURES and %GLADE_BUILD_TIME_HANDLERS are read
+ * each time signals are connected, so they can be set at any time.
+ * %GLADE_BUILD_PROFILE is ignored here (see glade_set_build_flags()).
+ */
+void
+glade_xml_set_build_flags(GladeXML *self, GladeBuildFlags flags)
+{
+    g_return_if_fail(GLADE_IS_XML(self));
+
+    self->priv->build_flags = flags;
+}
+
+/**
+ * glade_xml_get_build_flags:
+ * @self: the GladeXML object.
+ *
+ * Returns: the options of @self.
+ */
+GladeBuildFlags
+glade_xml_get_build_flags(GladeXML *self)
+{
+    g_return_val_if_fail(GLADE_IS_XML(self), 0);
+
+    return self->priv->build_flags;
+}
+
 static GtkWidget *
 glade_create_custom(GladeXML *xml, gchar *func_name, gchar *name,
 		    gchar *string1, gchar *string2, gint int1, gint int2)
@@ -1156,21 +2286,303 @@ glade_flags_from_string (GType type, const char *string)
     return ret;
 }
 
+/* let out all the notifications held back while building, and show
+ * the toplevels that were waiting for them.  Doing it once at the end
+ * means each property is notified at most once per widget, and the
+ * toplevels only queue a resize when the whole tree is in place. */
+static void
+glade_xml_thaw_widgets(GladeXML *self)
+{
+    GladeXMLPrivate *priv = self->priv;
+    GList *tmp;
+    guint i;
+
+    /* children were frozen after their parents, so thaw them first */
+    for (i = priv->frozen_widgets->len; i > 0; i--) {
+	GtkWidget *widget = g_ptr_array_index(priv->frozen_widgets, i - 1);
+
+	gtk_widget_thaw_child_notify(widget);
+	g_object_thaw_notify(G_OBJECT(widget));
+	g_object_unref(G_OBJECT(widget));
+    }
+    g_ptr_array_free(priv->frozen_widgets, TRUE);
+    priv->frozen_widgets = NULL;
+
+    priv->deferred_shows = g_list_reverse(priv->deferred_shows);
+    for (tmp = priv->deferred_shows; tmp; tmp = tmp->next) {
+	gtk_widget_show(GTK_WIDGET(tmp->data));
+	g_object_unref(tmp->data);
+    }
+    g_list_free(priv->deferred_shows);
+    priv->deferred_shows = NULL;
+}
+
+#define PREFETCH_THREADS 2
+
+/* the workers decoding images for GLADE_BUILD_PREFETCH_IMAGES.  The
+ * pool is kept for the life of the process, so a build doesn't wait
+ * for the images it queued: those the build loads itself are found in
+ * the cache by the workers. */
+static GThreadPool *prefetch_pool = NULL;
+
+static void
+glade_xml_prefetch_func(gpointer data, gpointer user_data)
+{
+    _glade_pixbuf_cache_prefetch(data);
+    g_free(data);
+}
+
+/* queue the image files referenced by a widget and its children for
+ * decoding.  There is no class information at this point, so go by
+ * the names of the properties that hold image filenames. */
+static void
+glade_xml_prefetch_images(GladeXML *self, GladeWidgetInfo *info,
+			  GThreadPool *pool, GHashTable *seen)
+{
+    guint i;
+
+    for (i = 0; i < info->n_properties; i++) {
+	const gchar *name = info->properties[i].name;
+	gchar *filename;
+
+	if (strcmp(name, "pixbuf") != 0 && strcmp(name, "icon") != 0 &&
+	    strcmp(name, "logo") != 0 && strcmp(name, "filename") != 0)
+	    continue;
+
+	filename = glade_xml_relative_file(self, info->properties[i].value);
+	if (g_hash_table_lookup(seen, filename) != NULL) {
+	    g_free(filename);
+	    continue;
+	}
+	g_hash_table_insert(seen, filename, filename);
+	g_thread_pool_push(pool, g_strdup(filename), NULL);
+    }
+
+    for (i = 0; i < info->n_children; i++)
+	if (info->children[i].child)
+	    glade_xml_prefetch_images(self, info->children[i].child,
+				      pool, seen);
+}
+
+/* a copy of @string in the GladeXML's pool, shared with any earlier
+ * copies of the same string */
+static const gchar *
+compact_string(GladeXMLPrivate *priv, GHashTable *seen, const gchar *string)
+{
+    gchar *copy;
+
+    if (!string)
+	return NULL;
+    copy = g_hash_table_lookup(seen, string);
+    if (!copy) {
+	copy = g_string_chunk_insert(priv->strings, string);
+	priv->strings_size += strlen(string) + 1;
+	g_hash_table_insert(seen, copy, copy);
+    }
+    return copy;
+}
+
+typedef struct {
+    GladeXMLPrivate *priv;
+    GHashTable *seen;
+    GHashTable *extra_signals;
+} compact_data;
+
+static gboolean
+compact_extra_signals(gpointer key, gpointer value, gpointer user_data)
+{
+    compact_data *data = user_data;
+    GArray *signals = value;
+    guint i;
+
+    for (i = 0; i < signals->len; i++) {
+	GladeSignalData *signal = &g_array_index(signals, GladeSignalData, i);
+
+	signal->signal_name = compact_string(data->priv, data->seen,
+					     signal->signal_name);
+	signal->connect_object = compact_string(data->priv, data->seen,
+						signal->connect_object);
+    }
+    g_hash_table_insert(data->extra_signals,
+			(gpointer)compact_string(data->priv, data->seen, key),
+			signals);
+    return TRUE;
+}
+
+/* with GLADE_BUILD_COMPACT, move what is still needed after the build
+ * out of the interface, which is then released: the names of the
+ * widgets and the signals to connect.  The index is copied without
+ * its references to the GladeWidgetInfos. */
+static void
+glade_xml_compact(GladeXML *self)
+{
+    GladeXMLPrivate *priv = self->priv;
+    GladeInterfaceIndex *old = priv->index;
+    GladeWidgetData *wdata;
+    compact_data data;
+    guint i;
+
+    /* deferred properties still refer to the interface */
+    if (!priv->tree || priv->deferred_props)
+	return;
+    if (priv->pending_atk) {
+	priv->compact_pending = TRUE;
+	return;
+    }
+    priv->compact_pending = FALSE;
+
+    glade_xml_forget_destroyed(self);
+    priv->strings = g_string_chunk_new(256);
+    data.priv = priv;
+    data.seen = g_hash_table_new(g_str_hash, g_str_equal);
+
+    /* the widget data is newest first, and the newest widget of a
+     * name is the one found by it */
+    g_hash_table_destroy(priv->name_hash);
+    priv->name_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    for (wdata = priv->widget_data; wdata; wdata = wdata->next) {
+	wdata->name = compact_string(priv, data.seen, wdata->name);
+	if (!g_hash_table_lookup(priv->name_hash, wdata->name))
+	    g_hash_table_insert(priv->name_hash, (gpointer)wdata->name, wdata);
+    }
+
+    if (old) {
+	GladeInterfaceIndex *index = g_new0(GladeInterfaceIndex, 1);
+	guint j;
+
+	/* only the signals of the widgets under the root, and the
+	 * handlers that still have some; the positions stay those of
+	 * the whole interface */
+	index->n_widgets = old->n_widgets;
+	for (i = 0; i < old->n_signals; i++)
+	    if (old->signals[i].signal_widget - priv->first_widget <
+		priv->n_widgets)
+		index->n_signals++;
+	index->signals = g_new(GladeSignalData, index->n_signals);
+	index->handlers = g_new(GladeHandlerSignals, old->n_handlers);
+	index->handler_hash = g_hash_table_new(g_str_hash, g_str_equal);
+	index->n_signals = 0;
+	for (i = 0; i < old->n_handlers; i++) {
+	    GladeHandlerSignals *handler = &index->handlers[index->n_handlers];
+
+	    handler->signals = index->signals + index->n_signals;
+	    handler->n_signals = 0;
+	    for (j = 0; j < old->handlers[i].n_signals; j++) {
+		const GladeSignalData *old_signal = &old->handlers[i].signals[j];
+		GladeSignalData *signal;
+
+		if (old_signal->signal_widget - priv->first_widget >=
+		    priv->n_widgets)
+		    continue;
+		signal = &handler->signals[handler->n_signals++];
+		*signal = *old_signal;
+		signal->signal_name = compact_string(priv, data.seen,
+						     signal->signal_name);
+		signal->connect_object = compact_string(priv, data.seen,
+							signal->connect_object);
+	    }
+	    if (handler->n_signals == 0)
+		continue;
+	    index->n_signals += handler->n_signals;
+	    index->n_handlers++;
+	    handler->handler_name =
+		compact_string(priv, data.seen, old->handlers[i].handler_name);
+	}
+	index->handlers = g_renew(GladeHandlerSignals, index->handlers,
+				  index->n_handlers);
+	for (i = 0; i < index->n_handlers; i++)
+	    g_hash_table_insert(index->handler_hash,
+				(gpointer)index->handlers[i].handler_name,
+				&index->handlers[i]);
+	priv->index = index;
+    }
+
+    if (priv->extra_signals) {
+	data.extra_signals = g_hash_table_new_full(g_str_hash, g_str_equal,
+						   NULL, free_signal_array);
+	g_hash_table_foreach_steal(priv->extra_signals,
+				   compact_extra_signals, &data);
+	g_hash_table_destroy(priv->extra_signals);
+	priv->extra_signals = data.extra_signals;
+    }
+
+    g_hash_table_destroy(data.seen);
+    glade_interface_unref(priv->tree);
+    priv->tree = NULL;
+}
+
+/* the number of widgets in the tree under @info, including it */
+static guint
+glade_widget_info_count(GladeWidgetInfo *info)
+{
+    guint n = 1;
+    gint i;
+
+    for (i = 0; i < info->n_children; i++)
+	if (info->children[i].child)
+	    n += glade_widget_info_count(info->children[i].child);
+    return n;
+}
+
 static void
 glade_xml_build_interface(GladeXML *self, GladeInterface *iface,
 			  const char *root)
 {
     gint i;
-    GladeWidgetInfo *wid;
+    GladeWidgetInfo *wid = NULL;
     GtkWidget *w;
+    gdouble start;
 
     /* make sure required modules are loaded */
+    GLADE_PROFILE_START(start);
     for (i = 0; i < iface->n_requires; i++)
 	glade_require(iface->requires[i]);
+    GLADE_PROFILE_END(start, REQUIRE, NULL);
 
     if (root) {
 	wid = g_hash_table_lookup(iface->names, root);
-	g_return_if_fail(wid != NULL);
+	if (wid == NULL) {
+	    g_critical("root widget `%s' not found in interface", root);
+	    return;
+	}
+    }
+
+    /* only room for the widgets that will be built */
+    self->priv->index = _glade_interface_get_private(iface)->index;
+    if (wid) {
+	self->priv->first_widget =
+	    GLADE_INDEX_WIDGET_POSITION(self->priv->index, wid);
+	self->priv->n_widgets = glade_widget_info_count(wid);
+    } else {
+	self->priv->first_widget = 0;
+	self->priv->n_widgets = self->priv->index->n_widgets;
+    }
+    self->priv->widgets = g_new0(GtkWidget *, self->priv->n_widgets);
+
+    /* lazy images are only loaded when they are shown, so there is
+     * nothing to prefetch */
+    if ((self->priv->build_flags & GLADE_BUILD_PREFETCH_IMAGES) &&
+	!(self->priv->build_flags & GLADE_BUILD_LAZY_IMAGES) &&
+	g_thread_supported()) {
+	GHashTable *seen = g_hash_table_new_full(g_str_hash, g_str_equal,
+						 g_free, NULL);
+
+	if (!prefetch_pool)
+	    prefetch_pool = g_thread_pool_new(glade_xml_prefetch_func, NULL,
+					      PREFETCH_THREADS, FALSE, NULL);
+	if (wid)
+	    glade_xml_prefetch_images(self, wid, prefetch_pool, seen);
+	else
+	    for (i = 0; i < iface->n_toplevels; i++)
+		glade_xml_prefetch_images(self, iface->toplevels[i],
+					  prefetch_pool, seen);
+	g_hash_table_destroy(seen);
+    }
+
+    if (self->priv->build_flags & GLADE_BUILD_FREEZE_NOTIFY)
+	self->priv->frozen_widgets = g_ptr_array_new();
+
+    if (wid) {
 	w = glade_xml_build_widget(self, wid);
     } else {
 	/* build all toplevel nodes */
@@ -1178,6 +2590,12 @@ glade_xml_build_interface(GladeXML *self, GladeInterface *iface,
 	    w = glade_xml_build_widget(self, iface->toplevels[i]);
 	}
     }
+
+    if (self->priv->frozen_widgets)
+	glade_xml_thaw_widgets(self);
+
+    if (self->priv->build_flags & GLADE_BUILD_COMPACT)
+	glade_xml_compact(self);
 }
 
 /* below are functions from glade-build.h */
@@ -1491,9 +2909,8 @@ glade_xml_set_value_from_string (GladeXML *xml,
 	if (G_VALUE_HOLDS(value, GDK_TYPE_COLOR)) {
 	    GdkColor colour = { 0, };
 
-	    if (gdk_color_parse(string, &colour) &&
-		gdk_colormap_alloc_color(gtk_widget_get_default_colormap(),
-					 &colour, FALSE, TRUE)) {
+	    if (_glade_colormap_get_color(gtk_widget_get_default_colormap(),
+					  string, &colour)) {
 		g_value_set_boxed(value, &colour);
 	    } else {
 		g_warning ("could not parse colour name `%s'", string);
@@ -1527,7 +2944,7 @@ glade_xml_set_value_from_string (GladeXML *xml,
 	    GdkPixbuf *pixbuf;
 
 	    filename = glade_xml_relative_file(xml, string);
-	    pixbuf = gdk_pixbuf_new_from_file(filename, &error);
+	    pixbuf = _glade_pixbuf_cache_load(filename, &error);
 	    if (pixbuf) {
 		g_value_set_object(value, pixbuf);
 		g_object_unref(G_OBJECT(pixbuf));
@@ -1539,8 +2956,7 @@ glade_xml_set_value_from_string (GladeXML *xml,
 	    g_free(filename);
 	} else if (g_type_is_a(GTK_TYPE_WIDGET, G_PARAM_SPEC_VALUE_TYPE(pspec)) ||
 		   g_type_is_a(G_PARAM_SPEC_VALUE_TYPE(pspec), GTK_TYPE_WIDGET)) {
-	    GtkWidget *widget = g_hash_table_lookup(xml->priv->name_hash,
-						    string);
+	    GtkWidget *widget = glade_xml_lookup(xml, string);
 	    if (widget) {
 		g_value_set_object(value, widget);
 	    } else {
@@ -1572,6 +2988,50 @@ struct _CustomPropData {
     GladeProperty *prop;
 };
 
+/* with GLADE_BUILD_LAZY_IMAGES, fill in a placeholder for pixbuf
+ * properties.  Returns FALSE if the value should be demarshalled
+ * normally. */
+static gboolean
+glade_xml_set_lazy_pixbuf(GladeXML *xml, GParamSpec *pspec,
+			  const gchar *string, GValue *value)
+{
+    GdkPixbuf *pixbuf;
+    gchar *filename;
+
+    if (!(xml->priv->build_flags & GLADE_BUILD_LAZY_IMAGES) ||
+	G_PARAM_SPEC_VALUE_TYPE(pspec) != GDK_TYPE_PIXBUF)
+	return FALSE;
+
+    filename = glade_xml_relative_file(xml, string);
+    pixbuf = _glade_pixbuf_placeholder_new(filename);
+    g_free(filename);
+    if (!pixbuf)
+	return FALSE;
+
+    g_value_init(value, GDK_TYPE_PIXBUF);
+    g_value_take_object(value, pixbuf);
+    return TRUE;
+}
+
+/* if a property was set to a placeholder for the file @string, load
+ * the real image when the widget gets mapped */
+static void
+glade_xml_watch_lazy_pixbuf(GladeXML *xml, GtkWidget *widget,
+			    GParamSpec *pspec, const GValue *value,
+			    const gchar *string)
+{
+    gchar *filename;
+
+    if (!G_VALUE_HOLDS(value, GDK_TYPE_PIXBUF) || !g_value_get_object(value) ||
+	!_glade_pixbuf_is_placeholder(g_value_get_object(value)))
+	return;
+
+    filename = glade_xml_relative_file(xml, string);
+    _glade_lazy_image_add(widget, filename, _glade_lazy_image_set_property,
+			  (gpointer)pspec->name);
+    g_free(filename);
+}
+
 /**
  * glade_standard_build_widget
  * @xml: the GladeXML object.
@@ -1596,6 +3056,7 @@ glade_standard_build_widget(GladeXML *xml, GType widget_type,
     GtkWidget *widget;
     GList *deferred_props = NULL, *tmp;
     guint i;
+    gdouble start;
 
     if (!props_array) {
 	props_array = g_array_new(FALSE, FALSE, sizeof(GParameter));
@@ -1608,6 +3069,7 @@ glade_standard_build_widget(GladeXML *xml, GType widget_type,
     custom_props = get_custom_prop_info(widget_type);
 
     /* collect properties */
+    GLADE_PROFILE_START(start);
     for (i = 0; i < info->n_properties; i++) {
 	GQuark name_quark;
 	GParameter param = { NULL };
@@ -1638,7 +3100,9 @@ glade_standard_build_widget(GladeXML *xml, GType widget_type,
 	    continue;
 	}
 
-	if (glade_xml_set_value_from_string(xml, pspec,
+	if (glade_xml_set_lazy_pixbuf(xml, pspec, info->properties[i].value,
+				      &param.value) ||
+	    glade_xml_set_value_from_string(xml, pspec,
 					    info->properties[i].value,
 					    &param.value)) {
 	    param.name = info->properties[i].name;
@@ -1651,8 +3115,31 @@ glade_standard_build_widget(GladeXML *xml, GType widget_type,
 					    &info->properties[i]);
 	}
     }
+    GLADE_PROFILE_END(start, PROPERTIES, info->classname);
+
+    GLADE_PROFILE_START(start);
     widget = g_object_newv(widget_type, props_array->len,
 			   (GParameter *)props_array->data);
+    GLADE_PROFILE_END(start, CONSTRUCT, info->classname);
+
+    if (xml->priv->build_flags & GLADE_BUILD_LAZY_IMAGES)
+	for (i = 0; i < props_array->len; i++) {
+	    GParameter *param = &g_array_index(props_array, GParameter, i);
+	    guint j;
+
+	    if (!G_VALUE_HOLDS(&param->value, GDK_TYPE_PIXBUF))
+		continue;
+	    /* the parameter's name is the property's own string */
+	    for (j = 0; j < info->n_properties; j++)
+		if (info->properties[j].name == param->name)
+		    break;
+	    if (j < info->n_properties)
+		glade_xml_watch_lazy_pixbuf(xml, widget,
+					    g_object_class_find_property(oclass,
+									 param->name),
+					    &param->value,
+					    info->properties[j].value);
+	}
 
     /* clean up props_array */
     for (i = 0; i < props_array->len; i++) {
@@ -1661,22 +3148,30 @@ glade_standard_build_widget(GladeXML *xml, GType widget_type,
     }
 
     /* do custom props */
+    GLADE_PROFILE_START(start);
     for (i = 0; i < custom_props_array->len; i++) {
 	CustomPropData *data;
 
 	data = &g_array_index(custom_props_array, CustomPropData, i);
-	if (data->apply_prop)
+	if (data->apply_prop) {
+	    GLADE_TRACE_BEGIN(data->prop->name, "custom prop",
+			      "value", data->prop->value);
 	    (* data->apply_prop) (xml, widget, data->prop->name,
 				  data->prop->value);
+	    GLADE_TRACE_END(data->prop->name, "custom prop");
+	}
     }
+    GLADE_PROFILE_END(start, CUSTOM_PROPS, info->classname);
 
     /* handle deferred properties */
+    GLADE_PROFILE_START(start);
     for (tmp = deferred_props; tmp; tmp = tmp->next) {
 	GladeProperty *prop = tmp->data;
 
 	glade_xml_handle_widget_prop(xml, widget, prop->name, prop->value);
     }
     g_list_free(deferred_props);
+    GLADE_PROFILE_END(start, PROPERTIES, info->classname);
 
     g_array_set_size(props_array, 0);
     g_array_set_size(custom_props_array, 0);
@@ -1716,6 +3211,78 @@ glade_xml_set_packing_property (GladeXML   *self,
     }
 }
 
+/* a packing property that has been looked up and converted, waiting
+ * to be applied to a child */
+typedef struct _PackingPropData PackingPropData;
+struct _PackingPropData {
+    GParamSpec *pspec;
+    GValue value;
+};
+
+/* look up and convert all the packing properties of a child in one go,
+ * appending them to packing_array. */
+static void
+glade_xml_collect_packing_properties(GladeXML *self, GtkWidget *parent,
+				     GladeChildInfo *child_info,
+				     GArray *packing_array)
+{
+    GObjectClass *oclass = G_OBJECT_GET_CLASS(parent);
+    guint i;
+
+    for (i = 0; i < child_info->n_properties; i++) {
+	const gchar *name  = child_info->properties[i].name;
+	const gchar *value = child_info->properties[i].value;
+	PackingPropData data = { NULL, { 0 } };
+
+	data.pspec = gtk_container_class_find_child_property(oclass, name);
+	if (!data.pspec) {
+	    g_warning("unknown child property `%s' for container `%s'",
+		      name, G_OBJECT_TYPE_NAME(parent));
+	    continue;
+	}
+	if (!(data.pspec->flags & G_PARAM_WRITABLE)) {
+	    g_warning("child property `%s' of container `%s' is not writable",
+		      name, G_OBJECT_TYPE_NAME(parent));
+	    continue;
+	}
+	if (glade_xml_set_value_from_string(self, data.pspec, value,
+					    &data.value))
+	    g_array_append_val(packing_array, data);
+    }
+}
+
+/* the array version of gtk_container_add_with_properties().  The
+ * pspecs have already been resolved and the values have the exact
+ * type of the pspec, so nothing needs converting.  Each value goes
+ * through gtk_container_child_set_property(), which validates it and
+ * warns about values out of range, while child notifications are
+ * queued on the frozen child and emitted together on thaw. */
+static void
+glade_container_add_with_packing(GtkContainer *container, GtkWidget *child,
+				 PackingPropData *props, guint n_props)
+{
+    guint i;
+
+    g_object_ref(G_OBJECT(container));
+    g_object_ref(G_OBJECT(child));
+    gtk_widget_freeze_child_notify(child);
+
+    gtk_container_add(container, child);
+
+    /* gtk_container_add may refuse the child (eg. a GtkBin that
+     * already has one), so make sure it really was packed */
+    if (child->parent == GTK_WIDGET(container)) {
+	for (i = 0; i < n_props; i++)
+	    gtk_container_child_set_property(container, child,
+					     props[i].pspec->name,
+					     &props[i].value);
+    }
+
+    gtk_widget_thaw_child_notify(child);
+    g_object_unref(G_OBJECT(child));
+    g_object_unref(G_OBJECT(container));
+}
+
 /**
  * glade_standard_build_children
  * @self: the GladeXML object.
@@ -1735,7 +3302,12 @@ void
 glade_standard_build_children(GladeXML *self, GtkWidget *parent,
 			      GladeWidgetInfo *info)
 {
-    gint i, j;
+    static GArray *packing_array = NULL;
+    gint i;
+    guint j;
+
+    if (!packing_array)
+	packing_array = g_array_new(FALSE, FALSE, sizeof(PackingPropData));
 
     g_object_ref(G_OBJECT(parent));
     for (i = 0; i < info->n_children; i++) {
@@ -1750,19 +3322,18 @@ glade_standard_build_children(GladeXML *self, GtkWidget *parent,
 
 	child = glade_xml_build_widget(self, childinfo);
 
-	g_object_ref(G_OBJECT(child));
-	gtk_widget_freeze_child_notify(child);
-
-	gtk_container_add(GTK_CONTAINER(parent), child);
-
-	for (j = 0; j < info->children[i].n_properties; j++)
-	    glade_xml_set_packing_property (
-		self, parent, child,
-		info->children[i].properties[j].name,
-		info->children[i].properties[j].value);
-	
-	gtk_widget_thaw_child_notify(child);
-	g_object_unref(G_OBJECT(child));
+	/* packing_array is only in use between here and the end of
+	 * the loop body, so recursive calls can't clobber it. */
+	glade_xml_collect_packing_properties(self, parent, &info->children[i],
+					     packing_array);
+	glade_container_add_with_packing(GTK_CONTAINER(parent), child,
+					 (PackingPropData *)packing_array->data,
+					 packing_array->len);
+
+	for (j = 0; j < packing_array->len; j++)
+	    g_value_unset(&g_array_index(packing_array, PackingPropData,
+					 j).value);
+	g_array_set_size(packing_array, 0);
     }
     g_object_unref(G_OBJECT(parent));
 }
@@ -1840,14 +3411,21 @@ glade_xml_build_widget(GladeXML *self, GladeWidgetInfo *info)
 {
     GType type = G_TYPE_INVALID;
     GtkWidget *ret;
+    gdouble start, lookup_start, counted = 0;
     
     GLADE_NOTE(BUILD, g_message("Widget class: %s\tname: %s",
 				info->classname, info->name));
+    GLADE_TRACE_BEGIN(info->name, "widget", "class", info->classname);
+    GLADE_PROFILE_START(start);
+    if (start >= 0)
+	counted = _glade_profile_total();
     if (!strcmp (info->classname, "Custom")) {
 	ret = custom_new (self, info);
     } else {
 		/* Call GladeXml's lookup_type() virtual function to get the gtype: */
+		GLADE_PROFILE_START(lookup_start);
 		type = (* GLADE_XML_GET_CLASS(self)->lookup_type) (self, info->classname);
+		GLADE_PROFILE_END(lookup_start, LOOKUP_TYPE, info->classname);
 
 	if (type == G_TYPE_INVALID) {
 	    char buf[50];
@@ -1858,6 +3436,13 @@ glade_xml_build_widget(GladeXML *self, GladeWidgetInfo *info)
 	    ret = get_build_data(type)->new(self, type, info);
 	}
     }
+    /* what the build function took beyond the phases it went through,
+     * such as all of it for ones that don't use
+     * glade_standard_build_widget() */
+    if (start >= 0)
+	_glade_profile_add(GLADE_PROFILE_BUILD, info->classname,
+			   _glade_get_time() - start -
+			   (_glade_profile_total() - counted));
 
     if (GTK_IS_WINDOW (ret))
 	glade_xml_set_toplevel (self, GTK_WINDOW (ret));
@@ -1867,6 +3452,12 @@ glade_xml_build_widget(GladeXML *self, GladeWidgetInfo *info)
     if (GTK_IS_WINDOW (ret))
 	glade_xml_set_toplevel (self, NULL);
 
+    if (start >= 0) {
+	_glade_profile_count_widget(info->classname);
+	profile_child_time += _glade_get_time() - start;
+    }
+    GLADE_TRACE_END(info->name, "widget");
+
     return ret;
 }
 
@@ -1965,10 +3556,14 @@ glade_xml_handle_internal_child(GladeXML *self, GtkWidget *parent,
 	   continue;
        }
 
-       if (glade_xml_set_value_from_string(self, pspec,
+       if (glade_xml_set_lazy_pixbuf(self, pspec, info->properties[i].value,
+				     &value) ||
+	   glade_xml_set_value_from_string(self, pspec,
 					   info->properties[i].value,
 					   &value)) {
 	   g_object_set_property(G_OBJECT(child), pspec->name, &value);
+	   glade_xml_watch_lazy_pixbuf(self, child, pspec, &value,
+				       info->properties[i].value);
 	   g_value_unset(&value);
        }
     }
@@ -1977,20 +3572,106 @@ glade_xml_handle_internal_child(GladeXML *self, GtkWidget *parent,
 }
 
 
+/* take @data out of widget_data */
+static void
+glade_xml_widget_unlink(GladeXMLPrivate *priv, GladeWidgetData *data)
+{
+    if (data->prev)
+	data->prev->next = data->next;
+    else
+	priv->widget_data = data->next;
+    if (data->next)
+	data->next->prev = data->prev;
+    data->next = data->prev = NULL;
+}
+
+/* drop the widgets destroyed with the last toplevel from name_hash,
+ * and free their GladeWidgetData */
 static void
-glade_xml_widget_destroy(GtkObject *object, GladeXML *xml)
+glade_xml_forget_destroyed(GladeXML *self)
 {
-    gchar *name;
+    GladeXMLPrivate *priv = self->priv;
+    GladeWidgetData *data, *next;
+
+    /* with nothing left, drop the whole table rather than each entry */
+    if (priv->n_live_widgets == 0) {
+	g_hash_table_destroy(priv->name_hash);
+	priv->name_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+
+    for (data = priv->dead_widget_data; data; data = next) {
+	next = data->next;
+	if (priv->n_live_widgets > 0 &&
+	    g_hash_table_lookup(priv->name_hash, data->name) == data)
+	    g_hash_table_remove(priv->name_hash, data->name);
+	g_free(data);
+    }
+    priv->dead_widget_data = NULL;
+}
 
-    g_return_if_fail(GTK_IS_OBJECT(object));
-    g_return_if_fail(GLADE_IS_XML(xml));
+/* the weak notify of widgets built, run when they are destroyed */
+static void
+glade_xml_widget_destroyed(gpointer user_data, GObject *object)
+{
+    GladeWidgetData *data = user_data;
+    GladeXMLPrivate *priv = data->xml->priv;
+    GtkWidget **slot;
+
+    g_object_steal_qdata(object, glade_xml_data_id);
+    data->destroyed = TRUE;
+    priv->n_live_widgets--;
+
+    /* don't connect signals to it any more */
+    slot = glade_xml_widget_slot(priv, data->slot);
+    if (slot && *slot == (GtkWidget *)object)
+	*slot = NULL;
+
+    glade_xml_widget_unlink(priv, data);
+    if (priv->dying) {
+	/* leave it in name_hash until the toplevel, which goes last,
+	 * after everything inside it */
+	data->next = priv->dead_widget_data;
+	priv->dead_widget_data = data;
+	if ((GObject *)priv->dying == object) {
+	    priv->dying = NULL;
+	    glade_xml_forget_destroyed(data->xml);
+	}
+    } else {
+	if (g_hash_table_lookup(priv->name_hash, data->name) == data)
+	    g_hash_table_remove(priv->name_hash, data->name);
+	g_free(data);
+    }
+}
 
-    name = g_object_get_qdata(G_OBJECT(object), glade_xml_name_id);
+/* the "destroy" handler of toplevels.  It runs before the toplevel's
+ * children are destroyed, so the bookkeeping of the whole window can be
+ * dropped in one go once it is gone, rather than widget by widget. */
+static void
+glade_xml_toplevel_destroy(GtkObject *object, GladeXML *xml)
+{
+    if (!xml->priv->dying)
+	xml->priv->dying = GTK_WIDGET(object);
+}
 
-    if (!name) return;
-    g_hash_table_remove(xml->priv->name_hash, name);
-    g_object_set_qdata(G_OBJECT(object), glade_xml_tree_id, NULL);
-    g_object_set_qdata(G_OBJECT(object), glade_xml_name_id, NULL);
+/* stop tracking a widget that is still alive.  The caller frees
+ * @data. */
+static void
+glade_xml_widget_detach(GladeWidgetData *data)
+{
+    GladeXMLPrivate *priv = data->xml->priv;
+    GObject *object = G_OBJECT(data->widget);
+
+    g_object_steal_qdata(object, glade_xml_data_id);
+    g_object_weak_unref(object, glade_xml_widget_destroyed, data);
+    if (data->toplevel)
+	g_signal_handlers_disconnect_by_func(object,
+					     glade_xml_toplevel_destroy,
+					     data->xml);
+    data->destroyed = TRUE;
+    priv->n_live_widgets--;
+    glade_xml_widget_unlink(priv, data);
+    if (g_hash_table_lookup(priv->name_hash, data->name) == data)
+	g_hash_table_remove(priv->name_hash, data->name);
 }
 
 /**
@@ -2011,29 +3692,66 @@ glade_xml_set_common_params(GladeXML *self, GtkWidget *widget,
 {
     GList *tmp;
     const GladeWidgetBuildData *data;
+    GladeWidgetData *wdata;
+    guint slot;
     static GQuark visible_id = 0;
+    gdouble start;
+
+    /* hold back notifications until the whole interface is built */
+    if (self->priv->frozen_widgets) {
+	g_object_ref(G_OBJECT(widget));
+	g_object_freeze_notify(G_OBJECT(widget));
+	gtk_widget_freeze_child_notify(widget);
+	g_ptr_array_add(self->priv->frozen_widgets, widget);
+    }
 
     /* get the build data */
     data = get_build_data(G_OBJECT_TYPE(widget));
-    glade_xml_add_signals(self, widget, info);
+    GLADE_PROFILE_START(start);
+    slot = glade_xml_add_signals(self, widget, info);
+    GLADE_PROFILE_END(start, SIGNALS, info->classname);
     glade_xml_add_accels(self, widget, info);
 
     gtk_widget_set_name(widget, info->name);
     glade_xml_add_accessibility_info(self, widget, info);
 
-    /* store this information as data of the widget. */
-    g_object_set_qdata(G_OBJECT(widget), glade_xml_tree_id, self);
-    g_object_set_qdata(G_OBJECT(widget), glade_xml_name_id, info->name);
+    /* store this information as data of the widget, with a weak
+     * reference to remove the widget from name_hash when it is
+     * destroyed.  This is much lighter than a "destroy" handler, which
+     * needs a closure per widget, and a weak reference on the GladeXML
+     * that makes its finalization quadratic. */
+    wdata = g_object_get_qdata(G_OBJECT(widget), glade_xml_data_id);
+    if (wdata && wdata->xml == self) {
+	wdata->name = info->name;
+	if (slot)
+	    wdata->slot = slot;
+    } else {
+	if (wdata) {
+	    /* built again by another GladeXML */
+	    glade_xml_widget_detach(wdata);
+	    g_free(wdata);
+	}
+	wdata = g_new(GladeWidgetData, 1);
+	wdata->xml = self;
+	wdata->name = info->name;
+	wdata->widget = widget;
+	wdata->slot = slot;
+	wdata->destroyed = FALSE;
+	wdata->toplevel = GTK_WIDGET_TOPLEVEL(widget);
+	wdata->prev = NULL;
+	wdata->next = self->priv->widget_data;
+	if (wdata->next)
+	    wdata->next->prev = wdata;
+	self->priv->widget_data = wdata;
+	self->priv->n_live_widgets++;
+	g_object_set_qdata(G_OBJECT(widget), glade_xml_data_id, wdata);
+	g_object_weak_ref(G_OBJECT(widget), glade_xml_widget_destroyed, wdata);
+	if (wdata->toplevel)
+	    g_signal_connect(widget, "destroy",
+			     G_CALLBACK(glade_xml_toplevel_destroy), self);
+    }
     /* store widgets in hash table, for easy lookup */
-    g_hash_table_insert(self->priv->name_hash, info->name, widget);
-
-    /* set up function to remove widget from GladeXML object's
-     * name_hash on destruction. Use connect_object so the handler is
-     * automatically removed on finalization of the GladeXML
-     * object. */
-    g_signal_connect_object(G_OBJECT(widget), "destroy",
-			    G_CALLBACK(glade_xml_widget_destroy),
-			    G_OBJECT(self), 0);
+    g_hash_table_insert(self->priv->name_hash, info->name, wdata);
 
     /* handle any deferred properties using this widget */
     tmp = self->priv->deferred_props;
@@ -2071,9 +3789,19 @@ glade_xml_set_common_params(GladeXML *self, GtkWidget *widget,
     }
 
     if (data && data->build_children && info->children) {
-	if (GTK_IS_CONTAINER (widget))
+	if (GTK_IS_CONTAINER (widget)) {
+	    gdouble saved_child_time = profile_child_time;
+
+	    profile_child_time = 0;
+	    GLADE_PROFILE_START(start);
 	    data->build_children(self, widget, info);
-	else
+	    /* leave out the time spent building the children themselves */
+	    if (start >= 0)
+		_glade_profile_add(GLADE_PROFILE_CHILDREN, info->classname,
+				   _glade_get_time() - start -
+				   profile_child_time);
+	    profile_child_time = saved_child_time;
+	} else
 	    g_warning ("widget %s (%s) has children, but is not a GtkContainer.",
 		       info->name, g_type_name (G_TYPE_FROM_INSTANCE (widget)));
     }
@@ -2081,8 +3809,16 @@ glade_xml_set_common_params(GladeXML *self, GtkWidget *widget,
     if (visible_id == 0)
 	visible_id = g_quark_from_static_string("Libglade::visible");
 
-    if (g_object_get_qdata(G_OBJECT(widget), visible_id))
-	gtk_widget_show(widget);
+    if (g_object_get_qdata(G_OBJECT(widget), visible_id)) {
+	/* showing a toplevel maps it, so wait until the notifications
+	 * have been let out */
+	if (self->priv->frozen_widgets && GTK_IS_WINDOW(widget)) {
+	    g_object_ref(G_OBJECT(widget));
+	    self->priv->deferred_shows =
+		g_list_prepend(self->priv->deferred_shows, widget);
+	} else
+	    gtk_widget_show(widget);
+    }
 }
 
 /**
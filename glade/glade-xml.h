@@ -24,6 +24,7 @@
 
 #include <glib.h>
 #include <gtk/gtk.h>
+#include <glade/glade-parser.h>
 
 G_BEGIN_DECLS
 
@@ -61,6 +62,8 @@ GladeXML  *glade_xml_new                 (const char *fname, const char *root,
 GladeXML  *glade_xml_new_from_buffer     (const char *buffer, int size,
 					  const char *root,
 					  const char *domain);
+GladeXML  *glade_xml_new_from_interface  (GladeInterface *iface,
+					  const char *root);
 gboolean   glade_xml_construct           (GladeXML *self, const char *fname,
 					  const char *root,
 					  const char *domain);
@@ -76,6 +79,17 @@ void       glade_xml_signal_connect_data (GladeXML *self,
 					  const char *handlername,
 					  GCallback func,
 					  gpointer user_data);
+
+typedef struct _GladeHandlerEntry GladeHandlerEntry;
+struct _GladeHandlerEntry {
+    const gchar *name;
+    GCallback callback;
+};
+
+void       glade_xml_signal_connect_table (GladeXML *self,
+					   const GladeHandlerEntry *table,
+					   guint n_entries,
+					   gpointer user_data);
 /*
  * use gmodule to connect signals automatically.  Basically a symbol with
  * the name of the signal handler is searched for, and that is connected to
@@ -108,6 +122,22 @@ void       glade_xml_signal_autoconnect_full (GladeXML *self,
 					      GladeXMLConnectFunc func,
 					      gpointer user_data);
 
+typedef struct _GladeSignalRecord GladeSignalRecord;
+struct _GladeSignalRecord {
+    const gchar *handler_name;
+    GObject *object;
+    const gchar *signal_name;
+    GObject *connect_object;
+    gboolean after;
+};
+
+GladeSignalRecord *glade_xml_get_signal_records (GladeXML *self,
+						 guint *n_records);
+void       glade_xml_signal_connect_closures (GladeXML *self,
+					      const GladeSignalRecord *records,
+					      GClosure **closures,
+					      guint n_records);
+
 
 GtkWidget *glade_xml_get_widget              (GladeXML *self,
 					      const char *name);
@@ -121,6 +151,8 @@ gchar     *glade_xml_relative_file           (GladeXML *self,
 const char *glade_get_widget_name      (GtkWidget *widget);
 GladeXML   *glade_get_widget_tree      (GtkWidget *widget);
 
+void glade_xml_get_memory_stats (GladeXML *self, GladeMemoryStats *stats);
+
 
 /* interface for changing the custom widget handling */
 typedef GtkWidget *(* GladeXMLCustomWidgetHandler) (GladeXML *xml,
@@ -135,6 +167,75 @@ typedef GtkWidget *(* GladeXMLCustomWidgetHandler) (GladeXML *xml,
 void glade_set_custom_handler(GladeXMLCustomWidgetHandler handler,
 			      gpointer user_data);
 
+/* options that change the way interfaces get built */
+typedef enum {
+    GLADE_BUILD_FREEZE_NOTIFY   = 1 << 0,
+    GLADE_BUILD_DEFER_ATK       = 1 << 1,
+    GLADE_BUILD_PREFETCH_IMAGES = 1 << 2,
+    GLADE_BUILD_LAZY_IMAGES     = 1 << 3,
+    GLADE_BUILD_SHARE_CLOSURES  = 1 << 4,
+    GLADE_BUILD_TIME_HANDLERS   = 1 << 5,
+    GLADE_BUILD_PROFILE         = 1 << 6,
+    GLADE_BUILD_COMPACT         = 1 << 7
+} GladeBuildFlags;
+
+void            glade_set_build_flags(GladeBuildFlags flags);
+GladeBuildFlags glade_get_build_flags(void);
+void            glade_xml_set_build_flags(GladeXML *self,
+					  GladeBuildFlags flags);
+GladeBuildFlags glade_xml_get_build_flags(GladeXML *self);
+
+void       glade_xml_apply_accessibility_info (GladeXML *self);
+
+void       glade_print_handler_stats (void);
+void       glade_reset_handler_stats (void);
+
+/* time spent building interfaces, with GLADE_BUILD_PROFILE */
+typedef enum {
+    GLADE_PROFILE_PARSE,
+    GLADE_PROFILE_REQUIRE,
+    GLADE_PROFILE_LOOKUP_TYPE,
+    GLADE_PROFILE_PROPERTIES,
+    GLADE_PROFILE_CONSTRUCT,
+    GLADE_PROFILE_CUSTOM_PROPS,
+    GLADE_PROFILE_CHILDREN,
+    GLADE_PROFILE_SIGNALS,
+    GLADE_PROFILE_ATK,
+    GLADE_PROFILE_BUILD,
+    GLADE_PROFILE_N_PHASES
+} GladeProfilePhase;
+
+/* phases may be added up to this many without changing the size of
+ * GladeProfileStats; the slots after GLADE_PROFILE_N_PHASES are zero */
+#define GLADE_PROFILE_MAX_PHASES 16
+
+typedef struct _GladeProfileStats GladeProfileStats;
+struct _GladeProfileStats {
+    const gchar *class_name;
+    guint n_widgets;
+    gdouble time[GLADE_PROFILE_MAX_PHASES]; /* in seconds */
+};
+
+GladeProfileStats *glade_get_profile_stats   (GladeProfileStats *totals,
+					      guint *n_classes);
+void               glade_print_profile_stats (void);
+void               glade_reset_profile_stats (void);
+
+gboolean glade_trace_start (const gchar *filename);
+void     glade_trace_stop  (void);
+
+/* the pixbuf cache shared by all GladeXML objects */
+void  glade_pixbuf_cache_set_max_size (gsize max_size);
+gsize glade_pixbuf_cache_get_max_size (void);
+void  glade_pixbuf_cache_get_stats    (guint *hits, guint *misses,
+				       gsize *size);
+void  glade_pixbuf_cache_clear        (void);
+
+/* the cache of functions looked up in the application */
+GCallback glade_symbol_cache_lookup    (const gchar *name);
+void      glade_symbol_cache_get_stats (guint *hits, guint *misses);
+void      glade_symbol_cache_clear     (void);
+
 #ifndef LIBGLADE_DISABLE_DEPRECATED
 #define glade_xml_new_with_domain glade_xml_new
 #define glade_xml_new_from_memory glade_xml_new_from_buffer
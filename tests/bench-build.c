@@ -0,0 +1,318 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * bench-build: time building interfaces, separately from parsing them.
+ * This needs a display; run it under Xvfb on headless machines.
+ *
+ *   bench-build [--runs=N] [file.glade...]
+ *
+ * Without files, it runs on the corpus: test.glade and
+ * gnome-widgets.glade from the corpus directory (converted from the
+ * ones in the top directory), and generated interfaces of 100, 1000
+ * and 10000 widgets, and of 2000 widgets with 4000 distinct signal
+ * handlers.  For each file it prints lines of
+ *
+ *   file op runs min_ms median_ms mean_ms
+ *
+ * for glade_parser_parse_file() (parse), glade_xml_new_from_interface()
+ * on the result (build), their sum, which is what glade_xml_new() does
+ * (new), glade_xml_signal_autoconnect() and teardown, then the
+ * glade_xml_get_widget() rate.  These runs are not profiled; the build
+ * time per widget class comes from as many more runs with
+ * GLADE_BUILD_PROFILE set, after them.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <gmodule.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <glade/glade.h>
+#include <glade/glade-parser.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "bench-generate.h"
+
+#ifndef BENCH_CORPUS_DIR
+#define BENCH_CORPUS_DIR "corpus"
+#endif
+
+static gint runs = 20;
+static guint n_warnings = 0;
+
+static GOptionEntry entries[] = {
+    { "runs", 'r', 0, G_OPTION_ARG_INT, &runs,
+      "Builds of each file", "N" },
+    { NULL }
+};
+
+/* the handler of generated interfaces with --handlers=1 */
+G_MODULE_EXPORT void
+bench_handler_0(GtkWidget *widget, gpointer user_data)
+{
+}
+
+/* generated interfaces refer to handlers that don't exist, and the
+ * converted ones to widgets that may not, so count the warnings
+ * rather than printing thousands of them */
+static void
+count_warning(const gchar *log_domain, GLogLevelFlags log_level,
+	      const gchar *message, gpointer user_data)
+{
+    n_warnings++;
+}
+
+static gint
+compare_times(gconstpointer a, gconstpointer b)
+{
+    gdouble time_a = *(const gdouble *)a, time_b = *(const gdouble *)b;
+
+    return time_a < time_b ? -1 : time_a > time_b;
+}
+
+static void
+report(const char *name, const char *op, gdouble *times, gint n)
+{
+    gdouble total = 0;
+    gint i;
+
+    qsort(times, n, sizeof(gdouble), compare_times);
+    for (i = 0; i < n; i++)
+	total += times[i];
+
+    g_print("%-24s %-12s %5d %10.3f %10.3f %10.3f\n", name, op, n,
+	    times[0] * 1000, times[n / 2] * 1000, total / n * 1000);
+}
+
+static void
+destroy_toplevels(GladeXML *xml)
+{
+    GList *toplevels, *tmp;
+
+    toplevels = gtk_window_list_toplevels();
+    for (tmp = toplevels; tmp; tmp = tmp->next)
+	if (glade_get_widget_tree(tmp->data) == xml)
+	    gtk_widget_destroy(tmp->data);
+    g_list_free(toplevels);
+}
+
+static void
+bench_lookup(const char *name, GladeXML *xml)
+{
+    GList *widgets, *tmp;
+    GPtrArray *names = g_ptr_array_new();
+    GTimer *timer = g_timer_new();
+    guint n_lookups = 0, i;
+
+    widgets = glade_xml_get_widget_prefix(xml, "");
+    for (tmp = widgets; tmp; tmp = tmp->next)
+	g_ptr_array_add(names, g_strdup(glade_get_widget_name(tmp->data)));
+    g_list_free(widgets);
+
+    if (names->len > 0) {
+	while (g_timer_elapsed(timer, NULL) < 0.2) {
+	    for (i = 0; i < names->len; i++)
+		glade_xml_get_widget(xml, g_ptr_array_index(names, i));
+	    n_lookups += names->len;
+	}
+	g_print("%-24s %-12s %5u %10.0f lookups/s\n", name, "lookup",
+		names->len, n_lookups / g_timer_elapsed(timer, NULL));
+    }
+
+    for (i = 0; i < names->len; i++)
+	g_free(g_ptr_array_index(names, i));
+    g_ptr_array_free(names, TRUE);
+    g_timer_destroy(timer);
+}
+
+/* a profiled pass, after the timed one so as not to slow it down */
+static void
+bench_classes(const char *filename, const char *name)
+{
+    GladeProfileStats *classes;
+    guint n_classes, j;
+    gint i;
+
+    glade_reset_profile_stats();
+    glade_set_build_flags(GLADE_BUILD_PROFILE);
+    for (i = 0; i < runs; i++) {
+	GladeXML *xml = glade_xml_new(filename, NULL, NULL);
+
+	destroy_toplevels(xml);
+	g_object_unref(xml);
+    }
+    glade_set_build_flags(0);
+
+    /* the profile covers every run, so scale it to one */
+    classes = glade_get_profile_stats(NULL, &n_classes);
+    for (j = 0; j < n_classes; j++) {
+	gdouble total = 0;
+	gint phase;
+
+	if (classes[j].n_widgets == 0)
+	    continue;
+	for (phase = 0; phase < GLADE_PROFILE_N_PHASES; phase++)
+	    total += classes[j].time[phase];
+	g_print("%-24s class:%-20s %7u widgets %10.3f us/widget\n", name,
+		classes[j].class_name, classes[j].n_widgets / runs,
+		total * 1e6 / classes[j].n_widgets);
+    }
+    g_free(classes);
+}
+
+static void
+bench_file(const char *filename, const char *name)
+{
+    gdouble *parse = g_new(gdouble, runs), *build = g_new(gdouble, runs);
+    gdouble *create = g_new(gdouble, runs);
+    gdouble *autoconnect = g_new(gdouble, runs);
+    gdouble *teardown = g_new(gdouble, runs);
+    GTimer *timer = g_timer_new();
+    gint i;
+
+    for (i = 0; i < runs; i++) {
+	GladeInterface *iface;
+	GladeXML *xml;
+
+	g_timer_start(timer);
+	iface = glade_parser_parse_file(filename, NULL);
+	parse[i] = g_timer_elapsed(timer, NULL);
+	if (!iface) {
+	    g_printerr("could not load %s\n", filename);
+	    exit(1);
+	}
+
+	g_timer_start(timer);
+	xml = glade_xml_new_from_interface(iface, NULL);
+	build[i] = g_timer_elapsed(timer, NULL);
+	create[i] = parse[i] + build[i];
+	glade_interface_unref(iface);
+
+	g_timer_start(timer);
+	glade_xml_signal_autoconnect(xml);
+	autoconnect[i] = g_timer_elapsed(timer, NULL);
+
+	if (i == runs - 1)
+	    bench_lookup(name, xml);
+
+	g_timer_start(timer);
+	destroy_toplevels(xml);
+	g_object_unref(xml);
+	teardown[i] = g_timer_elapsed(timer, NULL);
+    }
+    g_timer_destroy(timer);
+
+    report(name, "parse", parse, runs);
+    report(name, "build", build, runs);
+    report(name, "new", create, runs);
+    report(name, "autoconnect", autoconnect, runs);
+    report(name, "teardown", teardown, runs);
+    bench_classes(filename, name);
+
+    g_free(parse);
+    g_free(build);
+    g_free(create);
+    g_free(autoconnect);
+    g_free(teardown);
+}
+
+static void
+bench_generated(guint n_widgets, guint n_signals, guint n_handlers)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    GError *error = NULL;
+    GString *buffer;
+    gchar *filename, *name;
+    gint fd;
+
+    params.n_widgets = n_widgets;
+    params.n_signals = n_signals;
+    params.n_handlers = n_handlers;
+    buffer = bench_generate_interface(&params);
+
+    fd = g_file_open_tmp("bench-build-XXXXXX.glade", &filename, &error);
+    if (fd < 0) {
+	g_printerr("%s\n", error->message);
+	exit(1);
+    }
+    close(fd);
+    if (!g_file_set_contents(filename, buffer->str, buffer->len, &error)) {
+	g_printerr("%s\n", error->message);
+	exit(1);
+    }
+
+    name = g_strdup_printf("gen-%uw-%us-%uh", n_widgets, n_signals * n_widgets,
+			   n_handlers ? n_handlers : n_signals * n_widgets);
+    bench_file(filename, name);
+
+    g_unlink(filename);
+    g_free(filename);
+    g_free(name);
+    g_string_free(buffer, TRUE);
+}
+
+/* this runs from the main loop, as the corpus connects gtk_main_quit()
+ * to the destruction of windows */
+static gboolean
+run_benchmarks(gpointer data)
+{
+    gchar **files = data;
+    gint i;
+
+    g_print("# file op runs min_ms median_ms mean_ms\n");
+    if (files[0]) {
+	for (i = 0; files[i]; i++) {
+	    gchar *name = g_path_get_basename(files[i]);
+
+	    bench_file(files[i], name);
+	    g_free(name);
+	}
+    } else {
+	bench_file(BENCH_CORPUS_DIR "/test.glade", "test.glade");
+	bench_file(BENCH_CORPUS_DIR "/gnome-widgets.glade",
+		   "gnome-widgets.glade");
+	bench_generated(100, 1, 0);
+	bench_generated(1000, 1, 0);
+	bench_generated(10000, 1, 0);
+	/* thousands of distinct handlers, none of which exist */
+	bench_generated(2000, 2, 0);
+	/* the same signals on one handler that does */
+	bench_generated(2000, 2, 1);
+    }
+
+    if (n_warnings > 0)
+	g_print("# %u libglade warnings suppressed\n", n_warnings);
+
+    gtk_main_quit();
+    return FALSE;
+}
+
+int
+main(int argc, char **argv)
+{
+    GOptionContext *context;
+    GError *error = NULL;
+
+    if (!gtk_init_check(&argc, &argv)) {
+	g_message("Could not init gtk (run under Xvfb).  Skipping benchmark");
+	return 77;
+    }
+
+    context = g_option_context_new("[FILE...] - benchmark building interfaces");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+	g_printerr("%s\n", error->message);
+	return 1;
+    }
+    g_option_context_free(context);
+    runs = MAX(runs, 1);
+    g_log_set_handler("libglade", G_LOG_LEVEL_WARNING, count_warning, NULL);
+
+    g_idle_add(run_benchmarks, argv + 1);
+    gtk_main();
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * bench-generate: synthetic glade-2.0 interfaces for the benchmarks.
+ *
+ * Each toplevel window holds a chain of nested boxes, and the innermost
+ * box holds up to LEAVES_PER_WINDOW buttons, labels and entries, so the
+ * widget count, nesting depth and per-widget content can be varied
+ * independently.  The output only depends on the parameters.
+ */
+#include "bench-generate.h"
+
+#define LEAVES_PER_WINDOW 50
+
+typedef struct {
+    const char *name;
+    const char *value;  /* a format taking the widget number if a string */
+    gboolean is_string;
+} BenchProperty;
+
+typedef struct {
+    const char *classname;
+    const BenchProperty *properties;
+    guint n_properties;
+    const char *const *signals;
+    guint n_signals;
+    const char *accel_signal;
+} BenchClass;
+
+static const BenchProperty button_properties[] = {
+    { "label", "Button %u", TRUE },
+    { "visible", "True", FALSE },
+    { "sensitive", "True", FALSE },
+    { "can_focus", "True", FALSE },
+    { "use_underline", "True", FALSE },
+    { "relief", "GTK_RELIEF_NORMAL", FALSE },
+    { "focus_on_click", "True", FALSE },
+    { "width_request", "-1", FALSE },
+    { "height_request", "-1", FALSE },
+    { "can_default", "False", FALSE },
+};
+static const char *const button_signals[] = {
+    "clicked", "enter", "leave", "pressed", "released"
+};
+
+static const BenchProperty label_properties[] = {
+    { "label", "Label %u", TRUE },
+    { "visible", "True", FALSE },
+    { "sensitive", "True", FALSE },
+    { "use_underline", "False", FALSE },
+    { "use_markup", "False", FALSE },
+    { "justify", "GTK_JUSTIFY_LEFT", FALSE },
+    { "wrap", "False", FALSE },
+    { "selectable", "False", FALSE },
+    { "xalign", "0.5", FALSE },
+    { "yalign", "0.5", FALSE },
+};
+static const char *const label_signals[] = {
+    "copy_clipboard", "populate_popup", "move_cursor"
+};
+
+static const BenchProperty entry_properties[] = {
+    { "text", "Entry %u", TRUE },
+    { "visible", "True", FALSE },
+    { "sensitive", "True", FALSE },
+    { "can_focus", "True", FALSE },
+    { "editable", "True", FALSE },
+    { "visibility", "True", FALSE },
+    { "max_length", "0", FALSE },
+    { "has_frame", "True", FALSE },
+    { "activates_default", "False", FALSE },
+    { "width_chars", "-1", FALSE },
+};
+static const char *const entry_signals[] = {
+    "activate", "changed", "insert_at_cursor", "populate_popup"
+};
+
+static const BenchClass leaf_classes[] = {
+    { "GtkButton", button_properties, G_N_ELEMENTS(button_properties),
+      button_signals, G_N_ELEMENTS(button_signals), "clicked" },
+    { "GtkLabel", label_properties, G_N_ELEMENTS(label_properties),
+      label_signals, G_N_ELEMENTS(label_signals), "copy_clipboard" },
+    { "GtkEntry", entry_properties, G_N_ELEMENTS(entry_properties),
+      entry_signals, G_N_ELEMENTS(entry_signals), "activate" },
+};
+
+typedef struct {
+    const BenchInterfaceParams *params;
+    GString *out;
+    guint n_widgets;
+    guint n_signals;
+    gdouble translatable; /* carried over, so the ratio is exact */
+} BenchGenerator;
+
+static void
+indent(BenchGenerator *gen, guint level)
+{
+    guint i;
+
+    for (i = 0; i < level; i++)
+	g_string_append(gen->out, "  ");
+}
+
+static void
+add_property(BenchGenerator *gen, guint level, const char *name,
+	     const char *value, gboolean is_string)
+{
+    gboolean translatable = FALSE;
+
+    if (is_string) {
+	gen->translatable += gen->params->translatable;
+	if (gen->translatable >= 1.0) {
+	    gen->translatable -= 1.0;
+	    translatable = TRUE;
+	}
+    }
+    indent(gen, level);
+    g_string_append_printf(gen->out, "<property name=\"%s\"%s>%s</property>\n",
+			   name, translatable ? " translatable=\"yes\"" : "",
+			   value);
+}
+
+static void
+add_leaf(BenchGenerator *gen, guint level, guint number)
+{
+    const BenchClass *klass;
+    guint i;
+
+    klass = &leaf_classes[number % G_N_ELEMENTS(leaf_classes)];
+    indent(gen, level);
+    g_string_append(gen->out, "<child>\n");
+    indent(gen, level + 1);
+    g_string_append_printf(gen->out, "<widget class=\"%s\" id=\"widget%u\">\n",
+			   klass->classname, number);
+
+    for (i = 0; i < MIN(gen->params->n_properties, klass->n_properties); i++) {
+	const BenchProperty *prop = &klass->properties[i];
+
+	if (prop->is_string) {
+	    gchar *value = g_strdup_printf(prop->value, number);
+
+	    add_property(gen, level + 2, prop->name, value, TRUE);
+	    g_free(value);
+	} else
+	    add_property(gen, level + 2, prop->name, prop->value, FALSE);
+    }
+
+    for (i = 0; i < gen->params->n_signals; i++) {
+	const char *signal = klass->signals[i % klass->n_signals];
+
+	indent(gen, level + 2);
+	if (gen->params->n_handlers > 0)
+	    g_string_append_printf(gen->out,
+				   "<signal name=\"%s\" handler=\"bench_handler_%u\"/>\n",
+				   signal,
+				   gen->n_signals % gen->params->n_handlers);
+	else
+	    g_string_append_printf(gen->out,
+				   "<signal name=\"%s\" handler=\"on_widget%u_%s\"/>\n",
+				   signal, number, signal);
+	gen->n_signals++;
+    }
+
+    for (i = 0; i < gen->params->n_accels; i++) {
+	indent(gen, level + 2);
+	g_string_append_printf(gen->out,
+			       "<accelerator key=\"%c\" modifiers=\"%s\" signal=\"%s\"/>\n",
+			       'a' + (number + i) % 26,
+			       i % 2 ? "GDK_CONTROL_MASK | GDK_SHIFT_MASK"
+				     : "GDK_CONTROL_MASK",
+			       klass->accel_signal);
+    }
+
+    indent(gen, level + 1);
+    g_string_append(gen->out, "</widget>\n");
+    indent(gen, level + 1);
+    g_string_append(gen->out, "<packing>\n");
+    add_property(gen, level + 2, "expand", "False", FALSE);
+    add_property(gen, level + 2, "fill", "True", FALSE);
+    indent(gen, level + 1);
+    g_string_append(gen->out, "</packing>\n");
+    indent(gen, level);
+    g_string_append(gen->out, "</child>\n");
+}
+
+/* add a box nested @depth deep, holding @n_leaves leaves */
+static void
+add_box(BenchGenerator *gen, guint level, guint depth, guint n_leaves)
+{
+    guint i;
+
+    indent(gen, level);
+    g_string_append(gen->out, "<child>\n");
+    indent(gen, level + 1);
+    g_string_append_printf(gen->out,
+			   "<widget class=\"GtkVBox\" id=\"box%u\">\n",
+			   gen->n_widgets++);
+    add_property(gen, level + 2, "visible", "True", FALSE);
+    add_property(gen, level + 2, "homogeneous", "False", FALSE);
+    add_property(gen, level + 2, "spacing", "0", FALSE);
+
+    if (depth > 1)
+	add_box(gen, level + 2, depth - 1, n_leaves);
+    else
+	for (i = 0; i < n_leaves; i++)
+	    add_leaf(gen, level + 2, gen->n_widgets++);
+
+    indent(gen, level + 1);
+    g_string_append(gen->out, "</widget>\n");
+    indent(gen, level);
+    g_string_append(gen->out, "</child>\n");
+}
+
+/* returns the text of a glade-2.0 file with the shape given by
+ * @params.  Free it with g_string_free(). */
+GString *
+bench_generate_interface(const BenchInterfaceParams *params)
+{
+    BenchGenerator gen = { NULL };
+    guint depth = MAX(params->depth, 1);
+
+    gen.params = params;
+    gen.out = g_string_new("<?xml version=\"1.0\" standalone=\"no\"?>\n"
+			   "<!DOCTYPE glade-interface SYSTEM \"glade-2.0.dtd\">\n"
+			   "<glade-interface>\n");
+
+    while (gen.n_widgets < params->n_widgets) {
+	guint remaining = params->n_widgets - gen.n_widgets - 1;
+	guint n_boxes = MIN(depth, remaining);
+	guint n_leaves = MIN(LEAVES_PER_WINDOW, remaining - n_boxes);
+	gchar *title = g_strdup_printf("Window %u", gen.n_widgets);
+
+	g_string_append_printf(gen.out,
+			       "  <widget class=\"GtkWindow\" id=\"window%u\">\n",
+			       gen.n_widgets++);
+	add_property(&gen, 2, "title", title, TRUE);
+	add_property(&gen, 2, "visible", "False", FALSE);
+	g_free(title);
+
+	if (n_boxes > 0)
+	    add_box(&gen, 2, n_boxes, n_leaves);
+	g_string_append(gen.out, "  </widget>\n");
+    }
+
+    g_string_append(gen.out, "</glade-interface>\n");
+    return gen.out;
+}
@@ -0,0 +1,22 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+#ifndef BENCH_GENERATE_H
+#define BENCH_GENERATE_H
+
+#include <glib.h>
+
+/* the shape of a synthetic glade-2.0 interface */
+typedef struct {
+    guint n_widgets;      /* widgets in total, including containers */
+    guint depth;          /* boxes nested inside each window */
+    guint n_properties;   /* properties per leaf widget */
+    gdouble translatable; /* fraction of string properties to translate */
+    guint n_signals;      /* signals per leaf widget */
+    guint n_handlers;     /* distinct handler names, or 0 for one each */
+    guint n_accels;       /* accelerators per leaf widget */
+} BenchInterfaceParams;
+
+#define BENCH_INTERFACE_DEFAULTS { 1000, 4, 4, 0.5, 1, 0, 0 }
+
+GString *bench_generate_interface (const BenchInterfaceParams *params);
+
+#endif
@@ -0,0 +1,101 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * bench-notify: count the property and child property notifications
+ * dispatched while building an interface, with and without
+ * GLADE_BUILD_FREEZE_NOTIFY.
+ *
+ *   bench-notify [file.glade [iterations]]
+ */
+#include <stdlib.h>
+#include <gtk/gtk.h>
+#include <glade/glade.h>
+
+static guint n_notify = 0, n_child_notify = 0;
+
+static void (* orig_dispatch) (GObject *object, guint n_pspecs,
+			       GParamSpec **pspecs);
+static void (* orig_child_dispatch) (GtkWidget *widget, guint n_pspecs,
+				     GParamSpec **pspecs);
+
+static void
+count_dispatch(GObject *object, guint n_pspecs, GParamSpec **pspecs)
+{
+    n_notify += n_pspecs;
+    orig_dispatch(object, n_pspecs, pspecs);
+}
+
+static void
+count_child_dispatch(GtkWidget *widget, guint n_pspecs, GParamSpec **pspecs)
+{
+    n_child_notify += n_pspecs;
+    orig_child_dispatch(widget, n_pspecs, pspecs);
+}
+
+/* the notify signals can't take emission hooks, so hook the dispatch
+ * vfuncs of GtkWidget instead.  This has to happen before any widget
+ * subclass is initialised so that they all inherit the wrappers. */
+static void
+hook_dispatch(void)
+{
+    GtkWidgetClass *klass = g_type_class_ref(GTK_TYPE_WIDGET);
+
+    orig_dispatch = G_OBJECT_CLASS(klass)->dispatch_properties_changed;
+    G_OBJECT_CLASS(klass)->dispatch_properties_changed = count_dispatch;
+    orig_child_dispatch = klass->dispatch_child_properties_changed;
+    klass->dispatch_child_properties_changed = count_child_dispatch;
+}
+
+static void
+run(const char *filename, gint iterations, GladeBuildFlags flags,
+    const char *label)
+{
+    GTimer *timer;
+    gint i;
+
+    glade_set_build_flags(flags);
+    n_notify = n_child_notify = 0;
+
+    timer = g_timer_new();
+    for (i = 0; i < iterations; i++) {
+	GladeXML *xml = glade_xml_new(filename, NULL, NULL);
+	GList *toplevels, *tmp;
+
+	g_assert(xml != NULL);
+
+	toplevels = gtk_window_list_toplevels();
+	for (tmp = toplevels; tmp; tmp = tmp->next)
+	    if (glade_get_widget_tree(tmp->data) == xml)
+		gtk_widget_destroy(tmp->data);
+	g_list_free(toplevels);
+	g_object_unref(xml);
+    }
+    g_timer_stop(timer);
+
+    g_print("%-8s notify=%-8u child-notify=%-8u time=%.3fms/build\n",
+	    label, n_notify / iterations, n_child_notify / iterations,
+	    g_timer_elapsed(timer, NULL) * 1000.0 / iterations);
+    g_timer_destroy(timer);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *filename = "test-libglade-gtk.glade";
+    gint iterations = 20;
+
+    if (!gtk_init_check(&argc, &argv)) {
+	g_message("Could not init gtk.  Skipping benchmark");
+	return 77;
+    }
+    hook_dispatch();
+
+    if (argc > 1)
+	filename = argv[1];
+    if (argc > 2)
+	iterations = MAX(atoi(argv[2]), 1);
+
+    run(filename, iterations, 0, "default");
+    run(filename, iterations, GLADE_BUILD_FREEZE_NOTIFY, "frozen");
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * bench-parser: time glade_parser_parse_file(), glade_parser_parse_buffer()
+ * and glade_interface_destroy() on synthetic interfaces.  This does not
+ * call gtk_init(), so it runs without a display.
+ *
+ *   bench-parser [OPTION...]
+ *
+ * Without --widgets, the widget count is swept from 100 to 100000.
+ * Each line of output is one operation on one interface shape:
+ *
+ *   widgets depth props transl signals accels op runs min_ms median_ms
+ *   mean_ms rss_kb
+ *
+ * rss_kb is how much the resident memory of the process grew during
+ * the first run of the operation, negative if memory was given back.
+ * Later runs reuse the memory freed before them, so it is the
+ * parse_file row that says what an interface of that size costs; the
+ * parse_buffer row, which runs after that interface was destroyed,
+ * only shows what it needed beyond the memory left free.  It is read
+ * from /proc/self/statm, and is -1 where that doesn't exist.
+ *
+ * --output writes the generated interface to a file instead, so it can
+ * be used by other benchmarks.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glade/glade-parser.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "bench-generate.h"
+
+static BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+static gint runs = 0;
+static gchar *output = NULL;
+
+static GOptionEntry entries[] = {
+    { "widgets", 'w', 0, G_OPTION_ARG_INT, &params.n_widgets,
+      "Number of widgets (default: sweep 100 to 100000)", "N" },
+    { "depth", 'd', 0, G_OPTION_ARG_INT, &params.depth,
+      "Boxes nested in each window", "N" },
+    { "properties", 'p', 0, G_OPTION_ARG_INT, &params.n_properties,
+      "Properties per widget (at most 10)", "N" },
+    { "translatable", 't', 0, G_OPTION_ARG_DOUBLE, &params.translatable,
+      "Fraction of string properties marked translatable", "R" },
+    { "signals", 's', 0, G_OPTION_ARG_INT, &params.n_signals,
+      "Signals per widget", "N" },
+    { "handlers", 0, 0, G_OPTION_ARG_INT, &params.n_handlers,
+      "Distinct handler names (default: one per signal)", "N" },
+    { "accels", 'a', 0, G_OPTION_ARG_INT, &params.n_accels,
+      "Accelerators per widget", "N" },
+    { "runs", 'r', 0, G_OPTION_ARG_INT, &runs,
+      "Runs per measurement (default: scaled to the widget count)", "N" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+      "Write the interface to FILE and exit", "FILE" },
+    { NULL }
+};
+
+/* the resident memory of the process now, or -1 if it is unknown */
+static glong
+current_rss_kb(void)
+{
+#ifdef G_OS_UNIX
+    gchar *contents;
+    glong size, resident;
+    gboolean ok;
+
+    if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+	return -1;
+    ok = sscanf(contents, "%ld %ld", &size, &resident) == 2;
+    g_free(contents);
+    if (ok)
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    return -1;
+}
+
+/* the growth in resident memory since @before, if both are known */
+static glong
+rss_growth_kb(glong before)
+{
+    glong after = current_rss_kb();
+
+    return before >= 0 && after >= 0 ? after - before : -1;
+}
+
+static gint
+compare_times(gconstpointer a, gconstpointer b)
+{
+    gdouble time_a = *(const gdouble *)a, time_b = *(const gdouble *)b;
+
+    return time_a < time_b ? -1 : time_a > time_b;
+}
+
+static void
+report(const char *op, gdouble *times, gint n, glong rss_kb)
+{
+    gdouble total = 0;
+    gint i;
+
+    qsort(times, n, sizeof(gdouble), compare_times);
+    for (i = 0; i < n; i++)
+	total += times[i];
+
+    g_print("%7u %5u %5u %6.2f %7u %6u %-12s %5d %10.3f %10.3f %10.3f %11ld\n",
+	    params.n_widgets, params.depth, params.n_properties,
+	    params.translatable, params.n_signals, params.n_accels, op, n,
+	    times[0] * 1000, times[n / 2] * 1000, total / n * 1000, rss_kb);
+}
+
+static void
+run(gint n_runs)
+{
+    GString *buffer = bench_generate_interface(&params);
+    gdouble *parse_file = g_new(gdouble, n_runs);
+    gdouble *parse_buffer = g_new(gdouble, n_runs);
+    gdouble *destroy = g_new(gdouble, n_runs);
+    glong parse_file_rss = -1, parse_buffer_rss = -1, destroy_rss = -1;
+    GError *error = NULL;
+    GTimer *timer;
+    gchar *filename;
+    gint fd, i;
+
+    fd = g_file_open_tmp("bench-parser-XXXXXX.glade", &filename, &error);
+    if (fd < 0) {
+	g_printerr("%s\n", error->message);
+	exit(1);
+    }
+    close(fd);
+    if (!g_file_set_contents(filename, buffer->str, buffer->len, &error)) {
+	g_printerr("%s\n", error->message);
+	exit(1);
+    }
+
+    timer = g_timer_new();
+    for (i = 0; i < n_runs; i++) {
+	GladeInterface *iface;
+	glong rss = i == 0 ? current_rss_kb() : -1;
+
+	g_timer_start(timer);
+	iface = glade_parser_parse_file(filename, NULL);
+	parse_file[i] = g_timer_elapsed(timer, NULL);
+	g_assert(iface != NULL);
+	if (i == 0) {
+	    parse_file_rss = rss_growth_kb(rss);
+	    rss = current_rss_kb();
+	}
+
+	g_timer_start(timer);
+	glade_interface_destroy(iface);
+	destroy[i] = g_timer_elapsed(timer, NULL);
+	if (i == 0) {
+	    destroy_rss = rss_growth_kb(rss);
+	    rss = current_rss_kb();
+	}
+
+	g_timer_start(timer);
+	iface = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+	parse_buffer[i] = g_timer_elapsed(timer, NULL);
+	g_assert(iface != NULL);
+	if (i == 0)
+	    parse_buffer_rss = rss_growth_kb(rss);
+	glade_interface_destroy(iface);
+    }
+    g_timer_destroy(timer);
+
+    report("parse_file", parse_file, n_runs, parse_file_rss);
+    report("parse_buffer", parse_buffer, n_runs, parse_buffer_rss);
+    report("destroy", destroy, n_runs, destroy_rss);
+
+    g_unlink(filename);
+    g_free(filename);
+    g_free(parse_file);
+    g_free(parse_buffer);
+    g_free(destroy);
+    g_string_free(buffer, TRUE);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const guint sweep[] = { 100, 1000, 10000, 100000 };
+    GOptionContext *context;
+    GError *error = NULL;
+    guint i;
+
+    params.n_widgets = 0;
+    context = g_option_context_new("- benchmark the libglade parser");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+	g_printerr("%s\n", error->message);
+	return 1;
+    }
+    g_option_context_free(context);
+
+    if (output) {
+	GString *buffer;
+
+	if (params.n_widgets == 0)
+	    params.n_widgets = 1000;
+	buffer = bench_generate_interface(&params);
+	if (!g_file_set_contents(output, buffer->str, buffer->len, &error)) {
+	    g_printerr("%s\n", error->message);
+	    return 1;
+	}
+	g_string_free(buffer, TRUE);
+	return 0;
+    }
+
+    g_print("# widgets depth props transl signals accels op runs "
+	    "min_ms median_ms mean_ms rss_kb\n");
+    if (params.n_widgets > 0)
+	run(runs > 0 ? runs : MAX(200000 / params.n_widgets, 3));
+    else
+	for (i = 0; i < G_N_ELEMENTS(sweep); i++) {
+	    params.n_widgets = sweep[i];
+	    run(runs > 0 ? runs : MAX(200000 / params.n_widgets, 3));
+	}
+
+    return 0;
+}
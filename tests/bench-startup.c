@@ -0,0 +1,445 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * bench-startup: time from process start to the first frame of an
+ * interface, which includes realizing, style resolution and the first
+ * expose that the parse and build benchmarks leave out.
+ *
+ *   bench-startup [--runs=N] [--flags=FLAG,...] [--xvfb] FILE [TOPLEVEL]
+ *
+ * Each run is a fresh process (this program, run again with --child),
+ * which loads FILE, or only TOPLEVEL from it, shows the toplevel and
+ * waits for its first map-event and expose-event.  The times of each
+ * phase are aggregated over the runs into percentiles:
+ *
+ *   phase runs min_ms p50_ms p90_ms p99_ms max_ms
+ *
+ * exec is the time from spawning the child to main(), gtk_init is
+ * gtk_init() and connecting to the display, parse and build are
+ * glade_parser_parse_file() and glade_xml_new_from_interface(), the two
+ * halves of glade_xml_new(), show is gtk_widget_show() on the toplevel
+ * (realizing it and resolving styles), and map and expose are the waits
+ * for the events.  first_frame is the sum of them all.  A toplevel that is
+ * visible in FILE is shown by the build, so its show time is counted
+ * in build.
+ *
+ * --flags takes the names of GladeBuildFlags, such as defer-atk or
+ * lazy-images, so that they can be compared end to end.  --xvfb starts
+ * a private Xvfb server for the runs instead of using $DISPLAY.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glade/glade.h>
+#include <glade/glade-parser.h>
+
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+enum {
+    PHASE_EXEC,
+    PHASE_GTK_INIT,
+    PHASE_PARSE,
+    PHASE_BUILD,
+    PHASE_SHOW,
+    PHASE_MAP,
+    PHASE_EXPOSE,
+    N_PHASES
+};
+
+static const char *const phase_names[N_PHASES] = {
+    "exec", "gtk_init", "parse", "build", "show", "map", "expose"
+};
+
+static const struct {
+    const char *name;
+    GladeBuildFlags flag;
+} build_flags[] = {
+    { "freeze-notify", GLADE_BUILD_FREEZE_NOTIFY },
+    { "defer-atk", GLADE_BUILD_DEFER_ATK },
+    { "prefetch-images", GLADE_BUILD_PREFETCH_IMAGES },
+    { "lazy-images", GLADE_BUILD_LAZY_IMAGES },
+    { "share-closures", GLADE_BUILD_SHARE_CLOSURES },
+    { "compact", GLADE_BUILD_COMPACT },
+};
+
+static gint runs = 20;
+static gchar *flags = NULL;
+static gboolean use_xvfb = FALSE;
+static gboolean child = FALSE;
+static gdouble start_time = 0;
+
+static GOptionEntry entries[] = {
+    { "runs", 'r', 0, G_OPTION_ARG_INT, &runs,
+      "Processes to start", "N" },
+    { "flags", 'f', 0, G_OPTION_ARG_STRING, &flags,
+      "Build flags to set, separated by commas", "FLAG,..." },
+    { "xvfb", 'x', 0, G_OPTION_ARG_NONE, &use_xvfb,
+      "Run the processes on a private Xvfb server", NULL },
+    { "child", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &child,
+      NULL, NULL },
+    { "start", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_DOUBLE, &start_time,
+      NULL, NULL },
+    { NULL }
+};
+
+/* in seconds, on a clock that is the same in the child processes */
+static gdouble
+get_time(void)
+{
+#if GLIB_CHECK_VERSION(2, 28, 0)
+    return g_get_monotonic_time() / (gdouble)G_USEC_PER_SEC;
+#else
+    GTimeVal now;
+
+    g_get_current_time(&now);
+    return now.tv_sec + now.tv_usec / (gdouble)G_USEC_PER_SEC;
+#endif
+}
+
+static GladeBuildFlags
+parse_flags(const gchar *string)
+{
+    GladeBuildFlags result = 0;
+    gchar **names;
+    guint i, j;
+
+    if (!string)
+	return 0;
+    names = g_strsplit(string, ",", -1);
+    for (i = 0; names[i]; i++) {
+	for (j = 0; j < G_N_ELEMENTS(build_flags); j++)
+	    if (!strcmp(g_strstrip(names[i]), build_flags[j].name))
+		break;
+	if (j == G_N_ELEMENTS(build_flags)) {
+	    g_printerr("unknown build flag '%s'\n", names[i]);
+	    exit(1);
+	}
+	result |= build_flags[j].flag;
+    }
+    g_strfreev(names);
+    return result;
+}
+
+/* the child: one startup, printing the time of each phase */
+
+typedef struct {
+    gdouble times[N_PHASES];
+    gdouble last;
+} ChildState;
+
+static void
+child_mark(ChildState *state, gint phase)
+{
+    gdouble now = get_time();
+
+    state->times[phase] = now - state->last;
+    state->last = now;
+}
+
+static gboolean
+child_map_event(GtkWidget *widget, GdkEvent *event, ChildState *state)
+{
+    if (state->times[PHASE_MAP] == 0)
+	child_mark(state, PHASE_MAP);
+    return FALSE;
+}
+
+static gboolean
+child_expose_event(GtkWidget *widget, GdkEventExpose *event,
+		   ChildState *state)
+{
+    if (state->times[PHASE_EXPOSE] == 0 && state->times[PHASE_MAP] != 0) {
+	child_mark(state, PHASE_EXPOSE);
+	gtk_main_quit();
+    }
+    return FALSE;
+}
+
+static gboolean
+child_timeout(gpointer data)
+{
+    g_printerr("no expose-event after 10 seconds\n");
+    exit(1);
+    return FALSE;
+}
+
+static GtkWidget *
+find_toplevel(GladeXML *xml, const char *name)
+{
+    GList *toplevels, *tmp;
+    GtkWidget *widget = NULL;
+
+    if (name)
+	return glade_xml_get_widget(xml, name);
+
+    toplevels = gtk_window_list_toplevels();
+    for (tmp = toplevels; tmp && !widget; tmp = tmp->next)
+	if (glade_get_widget_tree(tmp->data) == xml)
+	    widget = tmp->data;
+    g_list_free(toplevels);
+    return widget;
+}
+
+static int
+run_child(int argc, char **argv, const char *filename, const char *root)
+{
+    ChildState state = { { 0 } };
+    GladeInterface *iface;
+    GladeXML *xml;
+    guint i;
+    GtkWidget *toplevel;
+
+    state.last = get_time();
+    if (start_time > 0)
+	state.times[PHASE_EXEC] = state.last - start_time;
+
+    if (!gtk_init_check(&argc, &argv))
+	return 77;
+    child_mark(&state, PHASE_GTK_INIT);
+
+    /* the two halves of glade_xml_new(), timed apart */
+    glade_set_build_flags(parse_flags(flags));
+    iface = glade_parser_parse_file(filename, NULL);
+    child_mark(&state, PHASE_PARSE);
+    if (!iface) {
+	g_printerr("could not load %s\n", filename);
+	return 1;
+    }
+    xml = glade_xml_new_from_interface(iface, root);
+    child_mark(&state, PHASE_BUILD);
+    glade_interface_unref(iface);
+
+    toplevel = find_toplevel(xml, root);
+    if (!toplevel || !GTK_IS_WINDOW(toplevel)) {
+	g_printerr("no toplevel window %s in %s\n", root ? root : "",
+		   filename);
+	return 1;
+    }
+    g_signal_connect(toplevel, "map-event",
+		     G_CALLBACK(child_map_event), &state);
+    g_signal_connect(toplevel, "expose-event",
+		     G_CALLBACK(child_expose_event), &state);
+
+    state.last = get_time();
+    gtk_widget_show(toplevel);
+    child_mark(&state, PHASE_SHOW);
+
+    g_timeout_add(10000, child_timeout, NULL);
+    gtk_main();
+
+    for (i = 0; i < N_PHASES; i++)
+	g_print("%s%.6f", i ? " " : "", state.times[i]);
+    g_print("\n");
+    return 0;
+}
+
+/* the parent: start the runs and aggregate them */
+
+static gint
+compare_times(gconstpointer a, gconstpointer b)
+{
+    gdouble time_a = *(const gdouble *)a, time_b = *(const gdouble *)b;
+
+    return time_a < time_b ? -1 : time_a > time_b;
+}
+
+/* the nearest-rank percentile of @n sorted times */
+static gdouble
+percentile(const gdouble *times, gint n, gint percent)
+{
+    gint rank = (n * percent + 99) / 100;
+
+    return times[CLAMP(rank, 1, n) - 1];
+}
+
+static void
+report(const char *phase, gdouble *times, gint n)
+{
+    qsort(times, n, sizeof(gdouble), compare_times);
+    g_print("%-12s %5d %10.3f %10.3f %10.3f %10.3f %10.3f\n", phase, n,
+	    times[0] * 1000, percentile(times, n, 50) * 1000,
+	    percentile(times, n, 90) * 1000, percentile(times, n, 99) * 1000,
+	    times[n - 1] * 1000);
+}
+
+#ifdef G_OS_UNIX
+static GPid xvfb_pid = 0;
+
+/* start Xvfb on a free display, and point the runs at it */
+static gboolean
+start_xvfb(void)
+{
+    gchar *argv[] = { "Xvfb", NULL, "-screen", "0", "1024x768x24",
+		      "-nolisten", "tcp", NULL };
+    GError *error = NULL;
+    gchar *socket = NULL;
+    gint display, i;
+
+    for (display = 99; display < 199; display++) {
+	socket = g_strdup_printf("/tmp/.X11-unix/X%d", display);
+	if (!g_file_test(socket, G_FILE_TEST_EXISTS))
+	    break;
+	g_free(socket);
+	socket = NULL;
+    }
+    if (!socket) {
+	g_printerr("no free display for Xvfb\n");
+	return FALSE;
+    }
+
+    argv[1] = g_strdup_printf(":%d", display);
+    if (!g_spawn_async(NULL, argv, NULL,
+		       G_SPAWN_SEARCH_PATH | G_SPAWN_STDOUT_TO_DEV_NULL |
+		       G_SPAWN_STDERR_TO_DEV_NULL,
+		       NULL, NULL, &xvfb_pid, &error)) {
+	g_printerr("could not start Xvfb: %s\n", error->message);
+	return FALSE;
+    }
+
+    /* wait for it to listen */
+    for (i = 0; i < 100 && !g_file_test(socket, G_FILE_TEST_EXISTS); i++)
+	g_usleep(G_USEC_PER_SEC / 20);
+    g_free(socket);
+    if (i == 100) {
+	g_printerr("Xvfb did not start\n");
+	return FALSE;
+    }
+
+    g_setenv("DISPLAY", argv[1], TRUE);
+    g_free(argv[1]);
+    return TRUE;
+}
+
+static void
+stop_xvfb(void)
+{
+    if (xvfb_pid) {
+	kill(xvfb_pid, SIGTERM);
+	g_spawn_close_pid(xvfb_pid);
+	xvfb_pid = 0;
+    }
+}
+#else
+static gboolean
+start_xvfb(void)
+{
+    g_printerr("--xvfb is not supported on this platform\n");
+    return FALSE;
+}
+
+static void
+stop_xvfb(void)
+{
+}
+#endif
+
+static int
+run_parent(const char *program, const char *filename, const char *root)
+{
+    gdouble *times[N_PHASES + 1];
+    GPtrArray *argv = g_ptr_array_new();
+    gchar *start_arg = NULL;
+    gint i, phase, status = 0;
+
+    for (phase = 0; phase <= N_PHASES; phase++)
+	times[phase] = g_new0(gdouble, runs);
+
+    if (use_xvfb && !start_xvfb())
+	return 1;
+
+    for (i = 0; i < runs; i++) {
+	GError *error = NULL;
+	gchar *output = NULL;
+	gchar **fields;
+
+	g_ptr_array_set_size(argv, 0);
+	g_ptr_array_add(argv, (gchar *)program);
+	g_ptr_array_add(argv, "--child");
+	g_free(start_arg);
+	start_arg = g_strdup_printf("--start=%.6f", get_time());
+	g_ptr_array_add(argv, start_arg);
+	if (flags) {
+	    g_ptr_array_add(argv, "--flags");
+	    g_ptr_array_add(argv, flags);
+	}
+	g_ptr_array_add(argv, (gchar *)filename);
+	if (root)
+	    g_ptr_array_add(argv, (gchar *)root);
+	g_ptr_array_add(argv, NULL);
+
+	if (!g_spawn_sync(NULL, (gchar **)argv->pdata, NULL,
+			  G_SPAWN_SEARCH_PATH, NULL, NULL,
+			  &output, NULL, &status, &error)) {
+	    g_printerr("could not run %s: %s\n", program, error->message);
+	    status = 1;
+	    break;
+	}
+#ifdef G_OS_UNIX
+	if (WIFEXITED(status))
+	    status = WEXITSTATUS(status);
+#endif
+	if (status != 0) {
+	    if (status == 77)
+		g_message("Could not init gtk (run under Xvfb, or with "
+			  "--xvfb).  Skipping benchmark");
+	    g_free(output);
+	    break;
+	}
+
+	fields = g_strsplit(g_strstrip(output), " ", -1);
+	for (phase = 0; phase < N_PHASES && fields[phase]; phase++) {
+	    times[phase][i] = g_ascii_strtod(fields[phase], NULL);
+	    times[N_PHASES][i] += times[phase][i];
+	}
+	g_strfreev(fields);
+	g_free(output);
+    }
+    stop_xvfb();
+
+    if (status == 0) {
+	g_print("# %s%s%s, flags: %s\n", filename, root ? " " : "",
+		root ? root : "", flags ? flags : "none");
+	g_print("# phase runs min_ms p50_ms p90_ms p99_ms max_ms\n");
+	for (phase = 0; phase < N_PHASES; phase++)
+	    report(phase_names[phase], times[phase], runs);
+	report("first_frame", times[N_PHASES], runs);
+    }
+
+    for (phase = 0; phase <= N_PHASES; phase++)
+	g_free(times[phase]);
+    g_ptr_array_free(argv, TRUE);
+    g_free(start_arg);
+    return status;
+}
+
+int
+main(int argc, char **argv)
+{
+    GOptionContext *context;
+    GError *error = NULL;
+
+    context = g_option_context_new("FILE [TOPLEVEL] - benchmark the time "
+				   "to the first frame");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+	g_printerr("%s\n", error->message);
+	return 1;
+    }
+    g_option_context_free(context);
+
+    if (argc < 2 || argc > 3) {
+	g_printerr("usage: %s [--runs=N] [--flags=FLAG,...] [--xvfb] "
+		   "FILE [TOPLEVEL]\n", argv[0]);
+	return 1;
+    }
+    parse_flags(flags);
+
+    if (child)
+	return run_child(argc, argv, argv[1], argv[2]);
+
+    runs = MAX(runs, 1);
+    return run_parent(argv[0], argv[1], argv[2]);
+}
@@ -0,0 +1,719 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+/*
+ * test-alloc: count the memory allocated by parsing, building and
+ * destroying interfaces, so that changes which add allocations per
+ * widget or per property, or which leak, fail "make check".
+ *
+ * All g_malloc() and g_slice calls go through a counting GMemVTable.
+ * Memory allocated by libxml2 is not counted.  The budgets are per
+ * widget, for a few shapes of generated interface; the parser is also
+ * given a budget per property, worked out from the difference between
+ * two interfaces that only differ in the number of properties.  The
+ * build is measured the same way, against a reference build without
+ * libglade.  If this glib ignores g_mem_set_vtable(), the test is
+ * skipped.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glade/glade.h>
+
+#include "bench-generate.h"
+
+/* parsing, per widget and per extra property of a leaf widget */
+#define PARSE_ALLOCS_PER_WIDGET   40
+#define PARSE_BYTES_PER_WIDGET    2048
+#define PARSE_ALLOCS_PER_PROPERTY 0.75
+
+/* building, per widget and per extra property, beyond a reference
+ * build of the same widgets made directly with GTK+ (see
+ * reference_build()).  GTK+'s own allocations vary between versions
+ * and dwarf libglade's, so they are left out, and what remains is
+ * libglade's bookkeeping: the widget data, its weak reference and
+ * qdata, and the name table.  Properties cost libglade nothing, so one
+ * more allocation per property fails. */
+#define BUILD_ALLOCS_PER_WIDGET   10
+#define BUILD_BYTES_PER_WIDGET    512
+#define BUILD_ALLOCS_PER_PROPERTY 0.5
+
+/* blocks GTK+ may keep after a second build and teardown of the same
+ * interface, such as grown hash tables.  A leak per widget is more. */
+#define TEARDOWN_LEAK_SLACK       32
+
+/* the size is kept before each block, padded to keep it aligned */
+typedef union {
+    gsize size;
+    long double align;
+} BlockHeader;
+
+static gulong n_allocs = 0;
+static gulong n_bytes = 0;
+static glong live_blocks = 0;
+
+static gpointer
+counting_malloc(gsize size)
+{
+    BlockHeader *block = malloc(sizeof(BlockHeader) + size);
+
+    if (!block)
+	return NULL;
+    block->size = size;
+    n_allocs++;
+    n_bytes += size;
+    live_blocks++;
+    return block + 1;
+}
+
+/* a realloc counts as an allocation of the bytes it adds */
+static gpointer
+counting_realloc(gpointer mem, gsize size)
+{
+    BlockHeader *block;
+    gsize old_size = 0;
+
+    if (!mem)
+	return counting_malloc(size);
+    block = (BlockHeader *)mem - 1;
+    old_size = block->size;
+    block = realloc(block, sizeof(BlockHeader) + size);
+    if (!block)
+	return NULL;
+    block->size = size;
+    n_allocs++;
+    if (size > old_size)
+	n_bytes += size - old_size;
+    return block + 1;
+}
+
+static void
+counting_free(gpointer mem)
+{
+    if (!mem)
+	return;
+    live_blocks--;
+    free((BlockHeader *)mem - 1);
+}
+
+static gpointer
+counting_calloc(gsize n_blocks, gsize n_block_bytes)
+{
+    gsize size = n_blocks * n_block_bytes;
+    gpointer mem = counting_malloc(size);
+
+    if (mem)
+	memset(mem, 0, size);
+    return mem;
+}
+
+static GMemVTable counting_vtable = {
+    counting_malloc,
+    counting_realloc,
+    counting_free,
+    counting_calloc,
+    NULL,
+    NULL
+};
+
+typedef struct {
+    gulong allocs;
+    gulong bytes;
+    glong blocks;
+} Counts;
+
+static void
+counts_start(Counts *counts)
+{
+    counts->allocs = n_allocs;
+    counts->bytes = n_bytes;
+    counts->blocks = live_blocks;
+}
+
+static void
+counts_stop(Counts *counts)
+{
+    counts->allocs = n_allocs - counts->allocs;
+    counts->bytes = n_bytes - counts->bytes;
+    counts->blocks = live_blocks - counts->blocks;
+}
+
+/* a window with its properties split by a signal, and a button with
+ * its accessibility properties split by an action.  Every group has to
+ * be kept, and none leaked. */
+static const char split_interface[] =
+"<?xml version=\"1.0\"?>\n"
+"<glade-interface>\n"
+"  <widget class=\"GtkWindow\" id=\"window1\">\n"
+"    <property name=\"title\">Split</property>\n"
+"    <signal name=\"destroy\" handler=\"on_destroy\"/>\n"
+"    <property name=\"visible\">False</property>\n"
+"    <child>\n"
+"      <widget class=\"GtkButton\" id=\"button1\">\n"
+"        <property name=\"label\">Button</property>\n"
+"        <accessibility>\n"
+"          <atkproperty name=\"AtkObject::accessible_name\">Name</atkproperty>\n"
+"          <atkaction action_name=\"click\" description=\"Click\"/>\n"
+"          <atkproperty name=\"AtkObject::accessible_description\">Description</atkproperty>\n"
+"        </accessibility>\n"
+"      </widget>\n"
+"    </child>\n"
+"  </widget>\n"
+"</glade-interface>\n";
+
+static gboolean
+test_split_properties(void)
+{
+    GladeInterface *iface;
+    GladeWidgetInfo *window, *button;
+    Counts counts;
+
+    g_print("Testing split property groups... ");
+    counts_start(&counts);
+    iface = glade_parser_parse_buffer(split_interface,
+				      strlen(split_interface), NULL);
+    if (!iface || iface->n_toplevels != 1) {
+	g_print("failed (could not parse)\n");
+	return FALSE;
+    }
+    window = iface->toplevels[0];
+    button = window->n_children > 0 ? window->children[0].child : NULL;
+    if (window->n_properties != 2 || !button || button->n_atk_props != 2) {
+	g_print("failed (property groups lost)\n");
+	return FALSE;
+    }
+    glade_interface_destroy(iface);
+    counts_stop(&counts);
+    if (counts.blocks != 0) {
+	g_print("failed (%ld blocks leaked)\n", counts.blocks);
+	return FALSE;
+    }
+    g_print("passed\n");
+    return TRUE;
+}
+
+/* parse @buffer, returning the allocations made, and check it does
+ * not leak */
+static gboolean
+parse_counts(const GString *buffer, Counts *counts)
+{
+    GladeInterface *iface;
+    glong blocks;
+
+    counts_start(counts);
+    iface = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    counts_stop(counts);
+    if (!iface) {
+	g_print("failed (could not parse)\n");
+	return FALSE;
+    }
+
+    blocks = live_blocks;
+    glade_interface_destroy(iface);
+    blocks -= live_blocks;
+    if (blocks != counts->blocks) {
+	g_print("failed (%ld blocks leaked)\n", counts->blocks - blocks);
+	return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+test_parse(const char *name, BenchInterfaceParams *params)
+{
+    GString *buffer = bench_generate_interface(params);
+    Counts counts;
+    gdouble allocs, bytes;
+
+    g_print("Testing parse of %s... ", name);
+    if (!parse_counts(buffer, &counts))
+	return FALSE;
+    g_string_free(buffer, TRUE);
+
+    allocs = (gdouble)counts.allocs / params->n_widgets;
+    bytes = (gdouble)counts.bytes / params->n_widgets;
+    if (allocs > PARSE_ALLOCS_PER_WIDGET || bytes > PARSE_BYTES_PER_WIDGET) {
+	g_print("failed (%.1f allocs and %.0f bytes per widget)\n",
+		allocs, bytes);
+	return FALSE;
+    }
+    g_print("passed (%.1f allocs, %.0f bytes per widget)\n", allocs, bytes);
+    return TRUE;
+}
+
+static guint
+count_leaves(GladeWidgetInfo *info)
+{
+    guint i, n_leaves = 0;
+
+    if (info->n_children == 0)
+	return 1;
+    for (i = 0; i < info->n_children; i++)
+	if (info->children[i].child)
+	    n_leaves += count_leaves(info->children[i].child);
+    return n_leaves;
+}
+
+/* the number of leaf widgets, which are the ones given properties */
+static guint
+n_leaves(const BenchInterfaceParams *params)
+{
+    GladeInterface *iface;
+    GString *buffer = bench_generate_interface(params);
+    guint i, n_leaves = 0;
+
+    iface = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    for (i = 0; iface && i < iface->n_toplevels; i++)
+	n_leaves += count_leaves(iface->toplevels[i]);
+    if (iface)
+	glade_interface_destroy(iface);
+    g_string_free(buffer, TRUE);
+    return MAX(n_leaves, 1);
+}
+
+static gboolean
+test_parse_per_property(void)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    GString *few, *many;
+    Counts few_counts, many_counts;
+    gdouble per_property;
+
+    g_print("Testing parse allocations per property... ");
+    params.n_properties = 2;
+    few = bench_generate_interface(&params);
+    params.n_properties = 10;
+    many = bench_generate_interface(&params);
+    if (!parse_counts(few, &few_counts) || !parse_counts(many, &many_counts))
+	return FALSE;
+    g_string_free(few, TRUE);
+    g_string_free(many, TRUE);
+
+    per_property = ((gdouble)many_counts.allocs - few_counts.allocs) /
+	(n_leaves(&params) * 8);
+    if (per_property > PARSE_ALLOCS_PER_PROPERTY) {
+	g_print("failed (%.2f allocs per property)\n", per_property);
+	return FALSE;
+    }
+    g_print("passed (%.2f allocs per property)\n", per_property);
+    return TRUE;
+}
+
+static void
+destroy_toplevels(GladeXML *xml)
+{
+    GList *toplevels, *tmp;
+
+    toplevels = gtk_window_list_toplevels();
+    for (tmp = toplevels; tmp; tmp = tmp->next)
+	if (glade_get_widget_tree(tmp->data) == xml)
+	    gtk_widget_destroy(tmp->data);
+    g_list_free(toplevels);
+}
+
+/* build @iface and tear it down again, returning the allocations made
+ * by the build in @build and the blocks left by the teardown in
+ * @leaked */
+static gboolean
+build_counts(GladeInterface *iface, Counts *build, glong *leaked)
+{
+    GladeXML *xml;
+    Counts total;
+
+    counts_start(&total);
+    counts_start(build);
+    xml = glade_xml_new_from_interface(iface, NULL);
+    counts_stop(build);
+    if (!xml) {
+	g_print("failed (could not build)\n");
+	return FALSE;
+    }
+
+    destroy_toplevels(xml);
+    g_object_unref(xml);
+    while (gtk_events_pending())
+	gtk_main_iteration();
+    counts_stop(&total);
+    *leaked = total.blocks;
+    return TRUE;
+}
+
+/* convert @string for @pspec without libglade.  Only the kinds of
+ * value in the generated interfaces are handled. */
+static gboolean
+reference_value(GParamSpec *pspec, const gchar *string, GValue *value)
+{
+    GType type = G_PARAM_SPEC_VALUE_TYPE(pspec);
+    GEnumClass *eclass;
+    GEnumValue *evalue;
+
+    switch (G_TYPE_FUNDAMENTAL(type)) {
+    case G_TYPE_STRING:
+	g_value_init(value, type);
+	g_value_set_string(value, string);
+	return TRUE;
+    case G_TYPE_BOOLEAN:
+	g_value_init(value, type);
+	g_value_set_boolean(value, string[0] == 'T' || string[0] == 't');
+	return TRUE;
+    case G_TYPE_INT:
+	g_value_init(value, type);
+	g_value_set_int(value, strtol(string, NULL, 0));
+	return TRUE;
+    case G_TYPE_UINT:
+	g_value_init(value, type);
+	g_value_set_uint(value, strtoul(string, NULL, 0));
+	return TRUE;
+    case G_TYPE_FLOAT:
+	g_value_init(value, type);
+	g_value_set_float(value, g_ascii_strtod(string, NULL));
+	return TRUE;
+    case G_TYPE_DOUBLE:
+	g_value_init(value, type);
+	g_value_set_double(value, g_ascii_strtod(string, NULL));
+	return TRUE;
+    case G_TYPE_ENUM:
+	eclass = g_type_class_ref(type);
+	evalue = g_enum_get_value_by_name(eclass, string);
+	if (evalue) {
+	    g_value_init(value, type);
+	    g_value_set_enum(value, evalue->value);
+	}
+	g_type_class_unref(eclass);
+	return evalue != NULL;
+    default:
+	return FALSE;
+    }
+}
+
+/* build @info and its children the way an application not using
+ * libglade would.  Nothing is allocated here beyond what GTK+ does. */
+static GtkWidget *
+reference_build(GladeWidgetInfo *info)
+{
+    GParameter params[16];
+    GObjectClass *oclass;
+    GtkWidget *widget;
+    guint n_params = 0, i, j;
+
+    memset(params, 0, sizeof(params));
+    oclass = g_type_class_ref(g_type_from_name(info->classname));
+    for (i = 0; i < info->n_properties && n_params < G_N_ELEMENTS(params);
+	 i++) {
+	GParamSpec *pspec;
+
+	pspec = g_object_class_find_property(oclass, info->properties[i].name);
+	if (pspec && reference_value(pspec, info->properties[i].value,
+				     &params[n_params].value))
+	    params[n_params++].name = info->properties[i].name;
+    }
+    widget = g_object_newv(G_OBJECT_CLASS_TYPE(oclass), n_params, params);
+    for (i = 0; i < n_params; i++)
+	g_value_unset(&params[i].value);
+    g_type_class_unref(oclass);
+    gtk_widget_set_name(widget, info->name);
+
+    for (i = 0; i < info->n_children; i++) {
+	GladeChildInfo *child_info = &info->children[i];
+	GtkWidget *child;
+
+	if (!child_info->child)
+	    continue;
+	child = reference_build(child_info->child);
+	gtk_container_add(GTK_CONTAINER(widget), child);
+	for (j = 0; j < child_info->n_properties; j++) {
+	    GValue value = { 0 };
+	    GParamSpec *pspec;
+
+	    pspec = gtk_container_class_find_child_property(
+		G_OBJECT_GET_CLASS(widget), child_info->properties[j].name);
+	    if (pspec && reference_value(pspec, child_info->properties[j].value,
+					 &value)) {
+		gtk_container_child_set_property(GTK_CONTAINER(widget), child,
+						 pspec->name, &value);
+		g_value_unset(&value);
+	    }
+	}
+    }
+    return widget;
+}
+
+/* the allocations made by a reference build of @iface */
+static void
+reference_counts(GladeInterface *iface, Counts *build)
+{
+    GtkWidget **toplevels = g_new(GtkWidget *, iface->n_toplevels);
+    guint i;
+
+    counts_start(build);
+    for (i = 0; i < iface->n_toplevels; i++)
+	toplevels[i] = reference_build(iface->toplevels[i]);
+    counts_stop(build);
+
+    for (i = 0; i < iface->n_toplevels; i++)
+	gtk_widget_destroy(toplevels[i]);
+    while (gtk_events_pending())
+	gtk_main_iteration();
+    g_free(toplevels);
+}
+
+/* the allocations of a build of @iface beyond the reference build,
+ * and the blocks left by its teardown */
+static gboolean
+overhead_counts(GladeInterface *iface, Counts *overhead, glong *leaked)
+{
+    Counts build, reference;
+
+    if (!build_counts(iface, &build, leaked))
+	return FALSE;
+    reference_counts(iface, &reference);
+    overhead->allocs = build.allocs - reference.allocs;
+    overhead->bytes = build.bytes - reference.bytes;
+    return TRUE;
+}
+
+static gboolean
+test_build(void)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    GString *buffer;
+    GladeInterface *few, *many;
+    Counts few_counts, many_counts;
+    gdouble allocs, bytes, per_property;
+    glong leaked;
+
+    params.n_widgets = 200;
+    params.n_properties = 2;
+    buffer = bench_generate_interface(&params);
+    few = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    g_string_free(buffer, TRUE);
+    params.n_properties = 10;
+    buffer = bench_generate_interface(&params);
+    many = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    g_string_free(buffer, TRUE);
+    if (!few || !many) {
+	g_print("failed (could not parse)\n");
+	return FALSE;
+    }
+
+    /* the first builds initialise classes, styles and quarks, which
+     * are kept, and index the interfaces, so only count the second
+     * ones */
+    if (!overhead_counts(few, &few_counts, &leaked) ||
+	!overhead_counts(many, &many_counts, &leaked))
+	return FALSE;
+
+    g_print("Testing build allocations... ");
+    if (!overhead_counts(many, &many_counts, &leaked))
+	return FALSE;
+    allocs = (gdouble)(glong)many_counts.allocs / params.n_widgets;
+    bytes = (gdouble)(glong)many_counts.bytes / params.n_widgets;
+    if (allocs > BUILD_ALLOCS_PER_WIDGET || bytes > BUILD_BYTES_PER_WIDGET) {
+	g_print("failed (%.1f allocs and %.0f bytes per widget)\n",
+		allocs, bytes);
+	return FALSE;
+    }
+    g_print("passed (%.1f allocs, %.0f bytes per widget)\n", allocs, bytes);
+
+    g_print("Testing teardown... ");
+    if (leaked > TEARDOWN_LEAK_SLACK) {
+	g_print("failed (%ld blocks leaked)\n", leaked);
+	return FALSE;
+    }
+    g_print("passed (%ld blocks kept)\n", leaked);
+
+    g_print("Testing build allocations per property... ");
+    if (!overhead_counts(few, &few_counts, &leaked))
+	return FALSE;
+    per_property = ((gdouble)(glong)many_counts.allocs -
+		    (gdouble)(glong)few_counts.allocs) /
+	(n_leaves(&params) * 8);
+    if (per_property > BUILD_ALLOCS_PER_PROPERTY) {
+	g_print("failed (%.2f allocs per property)\n", per_property);
+	return FALSE;
+    }
+    g_print("passed (%.2f allocs per property)\n", per_property);
+
+    glade_interface_unref(few);
+    glade_interface_unref(many);
+    return TRUE;
+}
+
+/* walk @info in document order, checking each widget info follows the
+ * previous one, and each widget's signals follow the previous ones */
+static gboolean
+check_packed(GladeWidgetInfo *info, GladeWidgetInfo **next,
+	     GladeSignalInfo **next_signal)
+{
+    guint i;
+
+    if (info != *next)
+	return FALSE;
+    (*next)++;
+    if (info->n_signals > 0) {
+	if (*next_signal && info->signals != *next_signal)
+	    return FALSE;
+	*next_signal = info->signals + info->n_signals;
+    }
+    for (i = 0; i < info->n_children; i++)
+	if (info->children[i].child &&
+	    (info->children[i].child->parent != info ||
+	     !check_packed(info->children[i].child, next, next_signal)))
+	    return FALSE;
+    return TRUE;
+}
+
+/* after parsing, the widget infos are in one array in document order,
+ * and the records of each kind in one array after them */
+static gboolean
+test_packed_interface(void)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    GString *buffer;
+    GladeInterface *iface;
+    GladeWidgetInfo *next, *info;
+    GladeSignalInfo *next_signal = NULL;
+    guint i;
+
+    g_print("Testing packed widget infos... ");
+    params.n_widgets = 500;
+    params.depth = 4;
+    params.n_signals = 2;
+    buffer = bench_generate_interface(&params);
+    iface = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    if (!iface || iface->n_toplevels == 0) {
+	g_print("failed (could not parse)\n");
+	return FALSE;
+    }
+
+    next = iface->toplevels[0];
+    for (i = 0; i < iface->n_toplevels; i++)
+	if (iface->toplevels[i]->parent != NULL ||
+	    !check_packed(iface->toplevels[i], &next, &next_signal)) {
+	    g_print("failed (widget infos not in document order)\n");
+	    return FALSE;
+	}
+    if (next - iface->toplevels[0] != params.n_widgets) {
+	g_print("failed (%d widget infos packed)\n",
+		(gint)(next - iface->toplevels[0]));
+	return FALSE;
+    }
+
+    info = g_hash_table_lookup(iface->names, "widget10");
+    if (!info || info < iface->toplevels[0] || info >= next ||
+	strcmp(info->name, "widget10") != 0) {
+	g_print("failed (names refer to unpacked widget infos)\n");
+	return FALSE;
+    }
+
+    glade_interface_destroy(iface);
+    g_string_free(buffer, TRUE);
+    g_print("passed\n");
+    return TRUE;
+}
+
+/* GladeXML objects built from one interface share it rather than
+ * copying it, and the last one frees it */
+static gboolean
+test_shared_interface(void)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    GString *buffer;
+    GladeInterface *iface;
+    GladeXML *first, *second;
+    GtkWidget *widget;
+    Counts counts;
+
+    g_print("Testing shared interfaces... ");
+    params.n_widgets = 200;
+    buffer = bench_generate_interface(&params);
+
+    counts_start(&counts);
+    iface = glade_parser_parse_buffer(buffer->str, buffer->len, NULL);
+    first = glade_xml_new_from_interface(iface, NULL);
+    second = glade_xml_new_from_interface(iface, NULL);
+    glade_interface_unref(iface);
+
+    widget = glade_xml_get_widget(second, "window0");
+    if (!widget || widget == glade_xml_get_widget(first, "window0") ||
+	glade_get_widget_tree(widget) != second) {
+	g_print("failed (widgets not built)\n");
+	return FALSE;
+    }
+
+    destroy_toplevels(first);
+    g_object_unref(first);
+    /* the interface is still used by the second one */
+    if (!glade_xml_get_widget(second, "widget10")) {
+	g_print("failed (interface freed too early)\n");
+	return FALSE;
+    }
+    destroy_toplevels(second);
+    g_object_unref(second);
+    while (gtk_events_pending())
+	gtk_main_iteration();
+    counts_stop(&counts);
+
+    if (counts.blocks > TEARDOWN_LEAK_SLACK) {
+	g_print("failed (%ld blocks leaked)\n", counts.blocks);
+	return FALSE;
+    }
+    g_print("passed\n");
+    g_string_free(buffer, TRUE);
+    return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+    BenchInterfaceParams params = BENCH_INTERFACE_DEFAULTS;
+    gulong before;
+
+    /* this has to come before anything is allocated, and g_slice has
+     * to use g_malloc() for its allocations to be seen */
+#ifdef G_OS_UNIX
+    setenv("G_SLICE", "always-malloc", TRUE);
+#endif
+    g_mem_set_vtable(&counting_vtable);
+
+    before = n_allocs;
+    g_free(g_malloc(1));
+    if (n_allocs == before) {
+	g_message("Allocations can not be counted.  Skipping test");
+	return 77; /* magic value to ignore test */
+    }
+
+    g_type_init();
+
+    /* the first parse sets up the parser's own buffers, which are kept */
+    n_leaves(&params);
+
+    if (!test_split_properties() || !test_packed_interface())
+	return 1;
+    if (!test_parse_per_property())
+	return 1;
+
+    if (!test_parse("1000 widgets", &params))
+	return 1;
+    params.depth = 20;
+    if (!test_parse("deep nesting", &params))
+	return 1;
+    params.depth = 4;
+    params.n_signals = 4;
+    params.n_accels = 2;
+    if (!test_parse("signals and accelerators", &params))
+	return 1;
+    params.n_properties = 10;
+    params.translatable = 1.0;
+    if (!test_parse("translated properties", &params))
+	return 1;
+
+    if (!gtk_init_check(&argc, &argv)) {
+	g_message("Could not init gtk.  Skipping build tests");
+	g_print("All tests passed\n");
+	return 0;
+    }
+    if (!test_build() || !test_shared_interface())
+	return 1;
+
+    g_print("All tests passed\n");
+    return 0;
+}
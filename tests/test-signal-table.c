@@ -0,0 +1,351 @@
+/* -*- mode: C; c-basic-offset: 4 -*- */
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glade/glade.h>
+
+static const char interface[] =
+"<?xml version=\"1.0\"?>\n"
+"<glade-interface>\n"
+"  <widget class=\"GtkWindow\" id=\"window1\">\n"
+"    <child>\n"
+"      <widget class=\"GtkVBox\" id=\"vbox1\">\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"button1\">\n"
+"            <signal name=\"clicked\" handler=\"on_clicked\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"button2\">\n"
+"            <signal name=\"clicked\" handler=\"on_swapped\"\n"
+"                    object=\"window1\" after=\"yes\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"button3\">\n"
+"            <signal name=\"clicked\" handler=\"on_unknown\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"      </widget>\n"
+"    </child>\n"
+"  </widget>\n"
+"</glade-interface>\n";
+
+/* each handler on two buttons, to share closures between */
+static const char shared_interface[] =
+"<?xml version=\"1.0\"?>\n"
+"<glade-interface>\n"
+"  <widget class=\"GtkWindow\" id=\"window2\">\n"
+"    <child>\n"
+"      <widget class=\"GtkVBox\" id=\"vbox2\">\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"shared1\">\n"
+"            <signal name=\"clicked\" handler=\"on_clicked\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"shared2\">\n"
+"            <signal name=\"clicked\" handler=\"on_clicked\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"shared3\">\n"
+"            <signal name=\"clicked\" handler=\"on_swapped\"\n"
+"                    object=\"window2\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"        <child>\n"
+"          <widget class=\"GtkButton\" id=\"shared4\">\n"
+"            <signal name=\"clicked\" handler=\"on_swapped\"\n"
+"                    object=\"window2\"/>\n"
+"          </widget>\n"
+"        </child>\n"
+"      </widget>\n"
+"    </child>\n"
+"  </widget>\n"
+"</glade-interface>\n";
+
+static gint n_clicked = 0, n_swapped = 0;
+static gpointer clicked_data = NULL, swapped_object = NULL;
+static GtkButton *clicked_button = NULL, *swapped_button = NULL;
+
+static void
+on_clicked(GtkButton *button, gpointer user_data)
+{
+    n_clicked++;
+    clicked_data = user_data;
+    clicked_button = button;
+}
+
+static void
+on_swapped(gpointer object, GtkButton *button)
+{
+    n_swapped++;
+    swapped_object = object;
+    swapped_button = button;
+}
+
+static gint n_guard_calls = 0;
+
+static void
+count_guard(gpointer data, GClosure *closure)
+{
+    n_guard_calls++;
+}
+
+static const GladeHandlerEntry handlers[] = {
+    { "on_swapped", G_CALLBACK(on_swapped) },
+    { "on_clicked", G_CALLBACK(on_clicked) },
+};
+
+int
+main(int argc, char **argv)
+{
+    GladeXML *xml, *compact, *shared;
+    GladeMemoryStats before, after;
+    GtkWidget *button;
+    GladeSignalRecord *records;
+    GClosure **closures, *closure;
+    GLogLevelFlags fatal_mask;
+    guint n_records;
+    gint n_before;
+    guint i;
+
+    if (!gtk_init_check(&argc, &argv)) {
+	g_message("Could not init gtk.  Skipping test");
+	return 77; /* magic value to ignore test */
+    }
+
+    xml = glade_xml_new_from_buffer(interface, strlen(interface), NULL, NULL);
+    if (!xml) {
+	g_print("could not build interface\n");
+	return 1;
+    }
+
+    g_print ("Testing glade_xml_signal_connect_table... ");
+    /* each call connects the signals again */
+    for (i = 0; i < 2; i++)
+	glade_xml_signal_connect_table(xml, handlers,
+				       G_N_ELEMENTS(handlers), xml);
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button1")));
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button2")));
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button3")));
+    if (n_clicked != 2 || clicked_data != xml ||
+	n_swapped != 2 ||
+	swapped_object != glade_xml_get_widget(xml, "window1")) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_print("passed\n");
+
+    g_print ("Testing glade_xml_get_signal_records... ");
+    records = glade_xml_get_signal_records(xml, &n_records);
+    closures = g_new0(GClosure *, n_records);
+    for (i = 0; i < n_records; i++) {
+	if (!strcmp(records[i].handler_name, "on_clicked"))
+	    closures[i] = g_cclosure_new(G_CALLBACK(on_clicked), xml, NULL);
+	else if (!strcmp(records[i].handler_name, "on_swapped") &&
+		 records[i].connect_object != NULL && records[i].after)
+	    closures[i] = g_cclosure_new_swap(G_CALLBACK(on_swapped),
+					      records[i].connect_object, NULL);
+    }
+    if (n_records != 3) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_print("passed\n");
+
+    g_print ("Testing glade_xml_signal_connect_closures... ");
+    glade_xml_signal_connect_closures(xml, records, closures, n_records);
+    n_clicked = n_swapped = 0;
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button1")));
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button2")));
+    /* the table connections from above are still there */
+    if (n_clicked != 3 || n_swapped != 3) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_print("passed\n");
+    g_free(closures);
+    g_free(records);
+
+    g_print ("Testing shared closures... ");
+    glade_xml_set_build_flags(xml, GLADE_BUILD_SHARE_CLOSURES);
+    glade_xml_signal_connect_data(xml, "on_clicked",
+				  G_CALLBACK(on_clicked), NULL);
+    glade_xml_signal_connect(xml, "on_swapped", G_CALLBACK(on_swapped));
+    glade_xml_set_build_flags(xml, 0);
+    n_clicked = n_swapped = 0;
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button1")));
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button2")));
+    if (n_clicked != 4 || clicked_data != NULL ||
+	n_swapped != 4 ||
+	swapped_object != glade_xml_get_widget(xml, "window1")) {
+	g_print("failed\n");
+	return 1;
+    }
+    /* one closure per handler serves both of its buttons */
+    shared = glade_xml_new_from_buffer(shared_interface,
+				       strlen(shared_interface), NULL, NULL);
+    if (!shared) {
+	g_print("failed\n");
+	return 1;
+    }
+    glade_xml_set_build_flags(shared, GLADE_BUILD_SHARE_CLOSURES);
+    glade_xml_signal_connect_data(shared, "on_clicked",
+				  G_CALLBACK(on_clicked), shared);
+    glade_xml_signal_connect(shared, "on_swapped", G_CALLBACK(on_swapped));
+    for (i = 0; i < 2; i++) {
+	button = glade_xml_get_widget(shared, i ? "shared2" : "shared1");
+	n_clicked = 0;
+	gtk_button_clicked(GTK_BUTTON(button));
+	if (n_clicked != 1 || clicked_button != GTK_BUTTON(button) ||
+	    clicked_data != shared) {
+	    g_print("failed\n");
+	    return 1;
+	}
+	button = glade_xml_get_widget(shared, i ? "shared4" : "shared3");
+	n_swapped = 0;
+	gtk_button_clicked(GTK_BUTTON(button));
+	if (n_swapped != 1 || swapped_button != GTK_BUTTON(button) ||
+	    swapped_object != glade_xml_get_widget(shared, "window2")) {
+	    g_print("failed\n");
+	    return 1;
+	}
+    }
+    gtk_widget_destroy(glade_xml_get_widget(shared, "window2"));
+    g_object_unref(shared);
+    g_print("passed\n");
+
+    g_print ("Testing building from a root... ");
+    shared = glade_xml_new_from_buffer(shared_interface,
+				       strlen(shared_interface), "shared2",
+				       NULL);
+    if (!shared) {
+	g_print("failed\n");
+	return 1;
+    }
+    glade_xml_signal_connect_data(shared, "on_clicked",
+				  G_CALLBACK(on_clicked), shared);
+    button = glade_xml_get_widget(shared, "shared2");
+    n_clicked = 0;
+    gtk_button_clicked(GTK_BUTTON(button));
+    if (n_clicked != 1 || clicked_button != GTK_BUTTON(button) ||
+	clicked_data != shared ||
+	glade_xml_get_widget(shared, "shared1") != NULL) {
+	g_print("failed\n");
+	return 1;
+    }
+    gtk_widget_destroy(button);
+    g_object_unref(shared);
+    g_print("passed\n");
+
+    g_print ("Testing timed closures... ");
+    /* a closure with guards of its own, connected twice, mustn't lose
+     * them or trip over libglade's */
+    fatal_mask = g_log_set_always_fatal(G_LOG_LEVEL_CRITICAL);
+    n_clicked = 0;
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button1")));
+    n_before = n_clicked;
+    closure = g_cclosure_new(G_CALLBACK(on_clicked), (gpointer)interface, NULL);
+    g_closure_add_marshal_guards(closure, NULL, count_guard,
+				 NULL, count_guard);
+    records = glade_xml_get_signal_records(xml, &n_records);
+    closures = g_new0(GClosure *, n_records);
+    for (i = 0; i < n_records; i++)
+	if (!strcmp(records[i].handler_name, "on_clicked"))
+	    closures[i] = closure;
+    glade_xml_set_build_flags(xml, GLADE_BUILD_TIME_HANDLERS);
+    g_closure_ref(closure);
+    glade_xml_signal_connect_closures(xml, records, closures, n_records);
+    glade_xml_signal_connect_closures(xml, records, closures, n_records);
+    glade_xml_set_build_flags(xml, 0);
+    n_clicked = 0;
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(xml, "button1")));
+    g_log_set_always_fatal(fatal_mask);
+    if (n_clicked != n_before + 2 || clicked_data != interface ||
+	n_guard_calls != 4) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_closure_unref(closure);
+    g_free(closures);
+    g_free(records);
+    g_print("passed\n");
+
+    g_print ("Testing compacted interfaces... ");
+    glade_set_build_flags(GLADE_BUILD_COMPACT);
+    compact = glade_xml_new_from_buffer(interface, strlen(interface),
+					NULL, NULL);
+    glade_set_build_flags(0);
+    if (!compact) {
+	g_print("failed\n");
+	return 1;
+    }
+    glade_xml_signal_connect_table(compact, handlers,
+				   G_N_ELEMENTS(handlers), compact);
+    n_clicked = n_swapped = 0;
+    button = glade_xml_get_widget(compact, "button1");
+    gtk_button_clicked(GTK_BUTTON(button));
+    gtk_button_clicked(GTK_BUTTON(glade_xml_get_widget(compact, "button2")));
+    if (n_clicked != 1 || clicked_data != compact || n_swapped != 1 ||
+	swapped_object != glade_xml_get_widget(compact, "window1") ||
+	strcmp(glade_get_widget_name(button), "button1") != 0) {
+	g_print("failed\n");
+	return 1;
+    }
+    gtk_widget_destroy(glade_xml_get_widget(compact, "window1"));
+    g_object_unref(compact);
+    /* built from a root, only the signals under it are kept */
+    glade_set_build_flags(GLADE_BUILD_COMPACT);
+    compact = glade_xml_new_from_buffer(interface, strlen(interface),
+					"button1", NULL);
+    glade_set_build_flags(0);
+    if (!compact) {
+	g_print("failed\n");
+	return 1;
+    }
+    glade_xml_get_memory_stats(compact, &after);
+    records = glade_xml_get_signal_records(compact, &n_records);
+    if (after.count[GLADE_MEMORY_SIGNALS] != 1 || n_records != 1 ||
+	strcmp(records[0].handler_name, "on_clicked") != 0) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_free(records);
+    gtk_widget_destroy(glade_xml_get_widget(compact, "button1"));
+    g_object_unref(compact);
+    g_print("passed\n");
+
+    g_print ("Testing destroying a widget... ");
+    glade_xml_get_memory_stats(xml, &before);
+    gtk_widget_destroy(glade_xml_get_widget(xml, "button3"));
+    glade_xml_get_memory_stats(xml, &after);
+    /* its bookkeeping goes with it, not with its toplevel */
+    if (glade_xml_get_widget(xml, "button3") != NULL ||
+	glade_xml_get_widget(xml, "button1") == NULL ||
+	after.bytes[GLADE_MEMORY_OTHER] >= before.bytes[GLADE_MEMORY_OTHER]) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_print("passed\n");
+
+    g_print ("Testing destroying the toplevel... ");
+    button = glade_xml_get_widget(xml, "button1");
+    g_object_ref(button);
+    gtk_widget_destroy(glade_xml_get_widget(xml, "window1"));
+    if (glade_xml_get_widget(xml, "window1") != NULL ||
+	glade_xml_get_widget(xml, "button1") != NULL ||
+	glade_xml_get_widget_prefix(xml, "") != NULL ||
+	glade_get_widget_tree(button) != NULL) {
+	g_print("failed\n");
+	return 1;
+    }
+    g_object_unref(button);
+    g_print("passed\n");
+
+    g_print ("All tests passed\n");
+
+    g_object_unref(xml);
+
+    return 0;
+}